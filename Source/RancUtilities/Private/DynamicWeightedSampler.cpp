@@ -0,0 +1,252 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "DynamicWeightedSampler.h"
+
+namespace
+{
+	// Written so NaN counts as 0 as well
+	double SanitizeWeight(float Weight)
+	{
+		return Weight > 0.f ? Weight : 0.0;
+	}
+}
+
+void FWeightedSumTree::Build(TConstArrayView<float> Weights)
+{
+	Reset();
+	Grow(Weights.Num());
+	NumSlots = Weights.Num();
+	LiveMask.Init(false, Capacity);
+	for (int32 i = 0; i < Weights.Num(); ++i)
+	{
+		Nodes[Capacity + i] = { SanitizeWeight(Weights[i]), 1 };
+		LiveMask[i] = true;
+	}
+
+	for (int32 Node = Capacity - 1; Node >= 1; --Node)
+	{
+		Nodes[Node].Weight = Nodes[Node * 2].Weight + Nodes[Node * 2 + 1].Weight;
+		Nodes[Node].NumLive = Nodes[Node * 2].NumLive + Nodes[Node * 2 + 1].NumLive;
+	}
+}
+
+void FWeightedSumTree::Reset()
+{
+	Nodes.Reset();
+	LiveMask.Reset();
+	FreeIndices.Reset();
+	Capacity = 0;
+	NumSlots = 0;
+}
+
+int32 FWeightedSumTree::Add(float Weight)
+{
+	int32 Index;
+	if (!FreeIndices.IsEmpty())
+	{
+		Index = FreeIndices.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Index = NumSlots++;
+		if (Index >= Capacity)
+		{
+			Grow(Index + 1);
+		}
+	}
+
+	LiveMask[Index] = true;
+	Nodes[Capacity + Index] = { SanitizeWeight(Weight), 1 };
+	UpdateParents(Capacity + Index);
+	return Index;
+}
+
+void FWeightedSumTree::Remove(int32 Index)
+{
+	if (!IsValidIndex(Index))
+	{
+		return;
+	}
+
+	LiveMask[Index] = false;
+	Nodes[Capacity + Index] = FNode();
+	UpdateParents(Capacity + Index);
+	FreeIndices.Add(Index);
+}
+
+void FWeightedSumTree::SetWeight(int32 Index, float Weight)
+{
+	if (!IsValidIndex(Index))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SetWeight: Index %d is not a live entry."), Index);
+		return;
+	}
+
+	Nodes[Capacity + Index].Weight = SanitizeWeight(Weight);
+	UpdateParents(Capacity + Index);
+}
+
+float FWeightedSumTree::GetWeight(int32 Index) const
+{
+	return IsValidIndex(Index) ? static_cast<float>(Nodes[Capacity + Index].Weight) : 0.f;
+}
+
+bool FWeightedSumTree::IsValidIndex(int32 Index) const
+{
+	return Index >= 0 && Index < NumSlots && LiveMask[Index];
+}
+
+template <typename RandomType>
+int32 FWeightedSumTree::SampleWith(RandomType& Random) const
+{
+	if (Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 Node = 1;
+	const double TotalWeight = Nodes[1].Weight;
+	if (TotalWeight <= 0.0)
+	{
+		// All weights are 0, descend by live counts to pick a live entry uniformly
+		int32 Remaining = Random.RandHelper(Nodes[1].NumLive);
+		while (Node < Capacity)
+		{
+			const int32 Left = Node * 2;
+			if (Remaining < Nodes[Left].NumLive)
+			{
+				Node = Left;
+			}
+			else
+			{
+				Remaining -= Nodes[Left].NumLive;
+				Node = Left + 1;
+			}
+		}
+		return Node - Capacity;
+	}
+
+	double Remaining = Random.FRand() * TotalWeight;
+	while (Node < Capacity)
+	{
+		const int32 Left = Node * 2;
+		// Rounding can leave Remaining just past the left sum, never step into an empty right subtree because of it
+		if (Remaining < Nodes[Left].Weight || Nodes[Left + 1].Weight <= 0.0)
+		{
+			Node = Left;
+		}
+		else
+		{
+			Remaining -= Nodes[Left].Weight;
+			Node = Left + 1;
+		}
+	}
+	return Node - Capacity;
+}
+
+int32 FWeightedSumTree::Sample() const
+{
+	FRancGlobalRandom Random;
+	return SampleWith(Random);
+}
+
+int32 FWeightedSumTree::Sample(FRancRandom& Random) const
+{
+	return SampleWith(Random);
+}
+
+int32 FWeightedSumTree::Sample(const FRandomStream& Stream) const
+{
+	return SampleWith(Stream);
+}
+
+void FWeightedSumTree::Grow(int32 MinCapacity)
+{
+	const int32 NewCapacity = static_cast<int32>(FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(MinCapacity, 1))));
+	if (NewCapacity <= Capacity)
+	{
+		return;
+	}
+
+	TArray<FNode> NewNodes;
+	NewNodes.SetNum(NewCapacity * 2);
+	for (int32 i = 0; i < NumSlots; ++i)
+	{
+		NewNodes[NewCapacity + i] = Nodes[Capacity + i];
+	}
+	for (int32 Node = NewCapacity - 1; Node >= 1; --Node)
+	{
+		NewNodes[Node].Weight = NewNodes[Node * 2].Weight + NewNodes[Node * 2 + 1].Weight;
+		NewNodes[Node].NumLive = NewNodes[Node * 2].NumLive + NewNodes[Node * 2 + 1].NumLive;
+	}
+
+	Nodes = MoveTemp(NewNodes);
+	LiveMask.SetNum(NewCapacity, false);
+	Capacity = NewCapacity;
+}
+
+void FWeightedSumTree::UpdateParents(int32 Node)
+{
+	for (Node /= 2; Node >= 1; Node /= 2)
+	{
+		Nodes[Node].Weight = Nodes[Node * 2].Weight + Nodes[Node * 2 + 1].Weight;
+		Nodes[Node].NumLive = Nodes[Node * 2].NumLive + Nodes[Node * 2 + 1].NumLive;
+	}
+}
+
+UDynamicWeightedSampler* UDynamicWeightedSampler::CreateDynamicWeightedSampler(UObject* Outer, const TArray<float>& Weights)
+{
+	UDynamicWeightedSampler* Sampler = NewObject<UDynamicWeightedSampler>(Outer ? Outer : GetTransientPackage());
+	Sampler->Build(Weights);
+	return Sampler;
+}
+
+void UDynamicWeightedSampler::Build(const TArray<float>& Weights)
+{
+	Tree.Build(Weights);
+}
+
+int UDynamicWeightedSampler::Add(float Weight)
+{
+	return Tree.Add(Weight);
+}
+
+void UDynamicWeightedSampler::Remove(int Index)
+{
+	Tree.Remove(Index);
+}
+
+void UDynamicWeightedSampler::SetWeight(int Index, float Weight)
+{
+	Tree.SetWeight(Index, Weight);
+}
+
+float UDynamicWeightedSampler::GetWeight(int Index) const
+{
+	return Tree.GetWeight(Index);
+}
+
+float UDynamicWeightedSampler::GetTotalWeight() const
+{
+	return static_cast<float>(Tree.GetTotalWeight());
+}
+
+int32 UDynamicWeightedSampler::Num() const
+{
+	return Tree.Num();
+}
+
+int UDynamicWeightedSampler::Sample() const
+{
+	return Tree.Sample();
+}
+
+int UDynamicWeightedSampler::SampleFromStream(const FRandomStream& Stream) const
+{
+	return Tree.Sample(Stream);
+}
+
+int UDynamicWeightedSampler::Sample(FRancRandom& Random) const
+{
+	return Tree.Sample(Random);
+}
@@ -0,0 +1,3 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "ISortKeyProvider.h"
\ No newline at end of file
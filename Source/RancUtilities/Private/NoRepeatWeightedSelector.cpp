@@ -0,0 +1,173 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "NoRepeatWeightedSelector.h"
+
+void FNoRepeatWeightedSampler::Build(TConstArrayView<float> Weights, int32 InExcludeLastN, float InSuppression, int32 InRecoveryDraws)
+{
+	ExcludeLastN = FMath::Max(InExcludeLastN, 0);
+	Suppression = FMath::Clamp(InSuppression, 0.f, 1.f);
+	RecoveryDraws = FMath::Max(InRecoveryDraws, 0);
+
+	BaseWeights = TArray<float>(Weights.GetData(), Weights.Num());
+	Tree.Build(Weights);
+	LastPickDraws.Init(INDEX_NONE, Weights.Num());
+	History.Init(INDEX_NONE, ExcludeLastN + RecoveryDraws);
+	NumDraws = 0;
+}
+
+int32 FNoRepeatWeightedSampler::Draw()
+{
+	return RecordPick(Tree.Sample());
+}
+
+int32 FNoRepeatWeightedSampler::Draw(FRancRandom& Random)
+{
+	return RecordPick(Tree.Sample(Random));
+}
+
+int32 FNoRepeatWeightedSampler::Draw(const FRandomStream& Stream)
+{
+	return RecordPick(Tree.Sample(Stream));
+}
+
+int32 FNoRepeatWeightedSampler::RecordPick(int32 Index)
+{
+	if (Index == INDEX_NONE || History.IsEmpty())
+	{
+		return Index;
+	}
+
+	const int64 DrawNumber = NumDraws++;
+	const int32 Slot = static_cast<int32>(DrawNumber % History.Num());
+
+	// The pick leaving the ring is fully recovered, unless the entry was picked again since
+	const int32 Expired = History[Slot];
+	if (Expired != INDEX_NONE && LastPickDraws[Expired] == DrawNumber - History.Num())
+	{
+		LastPickDraws[Expired] = INDEX_NONE;
+		Tree.SetWeight(Expired, BaseWeights[Expired]);
+	}
+
+	History[Slot] = Index;
+	LastPickDraws[Index] = DrawNumber;
+
+	// Only the picks still in the ring can change weight, so this is bounded by the history length
+	for (int32 Age = 0; Age < History.Num() && Age <= DrawNumber; ++Age)
+	{
+		const int64 PickDraw = DrawNumber - Age;
+		const int32 Picked = History[static_cast<int32>(PickDraw % History.Num())];
+		if (Picked != INDEX_NONE && LastPickDraws[Picked] == PickDraw)
+		{
+			// Entries deeper in their exclusion keep the 0 weight they got when picked
+			if (Age == 0 || Age >= ExcludeLastN)
+			{
+				Tree.SetWeight(Picked, BaseWeights[Picked] * GetScale(PickDraw));
+			}
+		}
+	}
+
+	return Index;
+}
+
+float FNoRepeatWeightedSampler::GetScale(int64 PickDraw) const
+{
+	if (PickDraw == INDEX_NONE)
+	{
+		return 1.f;
+	}
+
+	// Age as seen by the next draw
+	const int64 Age = NumDraws - 1 - PickDraw;
+	if (Age < ExcludeLastN)
+	{
+		return 0.f;
+	}
+
+	const int64 Recovered = Age - ExcludeLastN;
+	if (Recovered >= RecoveryDraws)
+	{
+		return 1.f;
+	}
+	return Suppression + (1.f - Suppression) * static_cast<float>(Recovered) / RecoveryDraws;
+}
+
+void FNoRepeatWeightedSampler::SetWeight(int32 Index, float Weight)
+{
+	if (!BaseWeights.IsValidIndex(Index))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SetWeight: Index %d is out of range."), Index);
+		return;
+	}
+
+	BaseWeights[Index] = Weight;
+	Tree.SetWeight(Index, Weight * GetScale(LastPickDraws[Index]));
+}
+
+float FNoRepeatWeightedSampler::GetEffectiveWeight(int32 Index) const
+{
+	return BaseWeights.IsValidIndex(Index) ? Tree.GetWeight(Index) : 0.f;
+}
+
+void FNoRepeatWeightedSampler::ResetHistory()
+{
+	for (int32 i = 0; i < BaseWeights.Num(); ++i)
+	{
+		if (LastPickDraws[i] != INDEX_NONE)
+		{
+			LastPickDraws[i] = INDEX_NONE;
+			Tree.SetWeight(i, BaseWeights[i]);
+		}
+	}
+	for (int32& Picked : History)
+	{
+		Picked = INDEX_NONE;
+	}
+	NumDraws = 0;
+}
+
+UNoRepeatWeightedSelector* UNoRepeatWeightedSelector::CreateNoRepeatWeightedSelector(UObject* Outer, const TArray<FSWeightedItem>& Items, int ExcludeLastN, float Suppression, int RecoveryDraws)
+{
+	UNoRepeatWeightedSelector* Selector = NewObject<UNoRepeatWeightedSelector>(Outer ? Outer : GetTransientPackage());
+	Selector->SetItems(Items, ExcludeLastN, Suppression, RecoveryDraws);
+	return Selector;
+}
+
+void UNoRepeatWeightedSelector::SetItems(const TArray<FSWeightedItem>& InItems, int ExcludeLastN, float Suppression, int RecoveryDraws)
+{
+	Items.Reset(InItems.Num());
+	TArray<float, TInlineAllocator<64>> Weights;
+	Weights.Reserve(InItems.Num());
+	for (const FSWeightedItem& Item : InItems)
+	{
+		Items.Add(Item.Item);
+		Weights.Add(Item.Weight);
+	}
+	Sampler.Build(Weights, ExcludeLastN, Suppression, RecoveryDraws);
+}
+
+UObject* UNoRepeatWeightedSelector::SelectItem()
+{
+	const int32 Index = Sampler.Draw();
+	return Index == INDEX_NONE ? nullptr : Items[Index];
+}
+
+int UNoRepeatWeightedSelector::SelectIndex()
+{
+	return Sampler.Draw();
+}
+
+UObject* UNoRepeatWeightedSelector::SelectItemFromStream(const FRandomStream& Stream)
+{
+	const int32 Index = Sampler.Draw(Stream);
+	return Index == INDEX_NONE ? nullptr : Items[Index];
+}
+
+void UNoRepeatWeightedSelector::SetItemWeight(int Index, float Weight)
+{
+	Sampler.SetWeight(Index, Weight);
+}
+
+void UNoRepeatWeightedSelector::ResetHistory()
+{
+	Sampler.ResetHistory();
+}
@@ -0,0 +1,373 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "RancFlowField.h"
+
+namespace
+{
+	constexpr float Unreachable = TNumericLimits<float>::Max();
+
+	float StepLength(int32 Direction)
+	{
+		return RancGrid::IsDiagonal(Direction) ? RancGrid::Sqrt2 : 1.f;
+	}
+}
+
+URancFlowField* URancFlowField::CreateFlowField(UObject* Outer, const FRancCostGrid& Grid, const TArray<FIntVector2D>& Goals)
+{
+	URancFlowField* FlowField = NewObject<URancFlowField>(Outer ? Outer : GetTransientPackage());
+	FlowField->Build(Grid, Goals);
+	return FlowField;
+}
+
+void URancFlowField::Build(const FRancCostGrid& InGrid, const TArray<FIntVector2D>& InGoals)
+{
+	if (InGrid.Costs.Num() != InGrid.Width * InGrid.Height)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Build: Costs has %d entries but the grid is %dx%d."), InGrid.Costs.Num(), InGrid.Width, InGrid.Height);
+		return;
+	}
+
+	Grid = InGrid;
+	const int32 NumCells = Grid.Num();
+	Integration.Init(Unreachable, NumCells);
+	Directions.Init(INDEX_NONE, NumCells);
+	QueueHandles.Init(INDEX_NONE, NumCells);
+	GoalMask.Init(false, NumCells);
+	InvalidatedMask.Init(false, NumCells);
+	Invalidated.Reset();
+	Queue.Reset();
+
+	for (const FIntVector2D& Goal : InGoals)
+	{
+		if (!Grid.IsValidCell(Goal))
+		{
+			continue;
+		}
+
+		// Blocked goals are remembered so they start attracting agents once they are opened
+		const int32 Index = Grid.ToIndex(Goal);
+		GoalMask[Index] = true;
+		if (Grid.Costs[Index] != 0)
+		{
+			Integration[Index] = 0.f;
+			QueueCell(Index);
+		}
+	}
+
+	Propagate();
+}
+
+void URancFlowField::SetCellCost(FIntVector2D Cell, uint8 Cost)
+{
+	SetCellCosts({Cell}, {Cost});
+}
+
+void URancFlowField::SetCellCosts(const TArray<FIntVector2D>& Cells, const TArray<uint8>& Costs)
+{
+	if (Cells.Num() != Costs.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SetCellCosts: Cells and Costs must have the same length (%d vs %d)."), Cells.Num(), Costs.Num());
+		return;
+	}
+
+	if (Integration.Num() != Grid.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SetCellCosts: The flow field has not been built."));
+		return;
+	}
+
+	Queue.Reset();
+
+	struct FCellChange
+	{
+		int32 Index;
+		uint8 OldCost;
+	};
+	TArray<FCellChange, TInlineAllocator<16>> Changes;
+
+	// First invalidate every route that got more expensive or is no longer allowed
+	for (int32 i = 0; i < Cells.Num(); ++i)
+	{
+		const FIntVector2D& Cell = Cells[i];
+		if (!Grid.IsValidCell(Cell))
+		{
+			continue;
+		}
+
+		const int32 Index = Grid.ToIndex(Cell);
+		const uint8 OldCost = Grid.Costs[Index];
+		const uint8 NewCost = Costs[i];
+		if (OldCost == NewCost)
+		{
+			continue;
+		}
+		Grid.Costs[Index] = NewCost;
+		Changes.Add({Index, OldCost});
+
+		if (OldCost != 0 && (NewCost == 0 || NewCost > OldCost))
+		{
+			// Every route stepping into this cell got more expensive
+			for (int32 Direction = 0; Direction < 8; ++Direction)
+			{
+				const int32 NeighborX = Cell.X + RancGrid::DirX[Direction];
+				const int32 NeighborY = Cell.Y + RancGrid::DirY[Direction];
+				if (!Grid.IsValidCell(NeighborX, NeighborY))
+				{
+					continue;
+				}
+
+				const int32 NeighborIndex = Grid.ToIndex(NeighborX, NeighborY);
+				if (Directions[NeighborIndex] == RancGrid::OppositeDirection[Direction])
+				{
+					InvalidateSubtree(NeighborIndex);
+				}
+			}
+		}
+
+		if (NewCost == 0)
+		{
+			InvalidateSubtree(Index);
+
+			// Diagonal steps squeezing past this cell would now cut a blocked corner
+			for (int32 Direction = 0; Direction < 8; ++Direction)
+			{
+				const int32 NeighborX = Cell.X + RancGrid::DirX[Direction];
+				const int32 NeighborY = Cell.Y + RancGrid::DirY[Direction];
+				if (!Grid.IsValidCell(NeighborX, NeighborY))
+				{
+					continue;
+				}
+
+				const int32 NeighborIndex = Grid.ToIndex(NeighborX, NeighborY);
+				const int32 NeighborDirection = Directions[NeighborIndex];
+				if (NeighborDirection != INDEX_NONE && RancGrid::IsDiagonal(NeighborDirection))
+				{
+					const bool bCornerX = NeighborX + RancGrid::DirX[NeighborDirection] == Cell.X && NeighborY == Cell.Y;
+					const bool bCornerY = NeighborX == Cell.X && NeighborY + RancGrid::DirY[NeighborDirection] == Cell.Y;
+					if (bCornerX || bCornerY)
+					{
+						InvalidateSubtree(NeighborIndex);
+					}
+				}
+			}
+		}
+	}
+
+	// Rebuild the invalidated cells from the intact field around them
+	for (const int32 Index : Invalidated)
+	{
+		if (GoalMask[Index] && Grid.Costs[Index] != 0)
+		{
+			Integration[Index] = 0.f;
+			QueueCell(Index);
+		}
+		else
+		{
+			RecomputeFromNeighbours(Index);
+		}
+	}
+
+	// Cheaper or newly opened cells can shorten the routes of the cells around them
+	for (const FCellChange& Change : Changes)
+	{
+		const int32 Index = Change.Index;
+		if (Grid.Costs[Index] == 0)
+		{
+			continue;
+		}
+
+		if (GoalMask[Index])
+		{
+			Integration[Index] = 0.f;
+			Directions[Index] = INDEX_NONE;
+			QueueCell(Index);
+		}
+		else
+		{
+			RecomputeFromNeighbours(Index);
+			if (Integration[Index] != Unreachable)
+			{
+				QueueCell(Index);
+			}
+		}
+
+		if (Change.OldCost == 0)
+		{
+			// Opening a cell also unblocks diagonal steps between its neighbours
+			const FIntVector2D Cell = Grid.ToCell(Index);
+			for (int32 Direction = 0; Direction < 8; ++Direction)
+			{
+				const int32 NeighborX = Cell.X + RancGrid::DirX[Direction];
+				const int32 NeighborY = Cell.Y + RancGrid::DirY[Direction];
+				if (Grid.IsValidCell(NeighborX, NeighborY) && Integration[Grid.ToIndex(NeighborX, NeighborY)] != Unreachable)
+				{
+					QueueCell(Grid.ToIndex(NeighborX, NeighborY));
+				}
+			}
+		}
+	}
+
+	Propagate();
+
+	for (const int32 Index : Invalidated)
+	{
+		InvalidatedMask[Index] = false;
+	}
+	Invalidated.Reset();
+}
+
+FIntVector2D URancFlowField::GetFlowDirection(FIntVector2D Cell) const
+{
+	if (!Grid.IsValidCell(Cell) || Directions.Num() != Grid.Num())
+	{
+		return FIntVector2D();
+	}
+
+	const int32 Direction = Directions[Grid.ToIndex(Cell)];
+	return Direction == INDEX_NONE ? FIntVector2D() : FIntVector2D(RancGrid::DirX[Direction], RancGrid::DirY[Direction]);
+}
+
+bool URancFlowField::GetNextCell(FIntVector2D Cell, FIntVector2D& OutNextCell) const
+{
+	const FIntVector2D Direction = GetFlowDirection(Cell);
+	OutNextCell = Cell + Direction;
+	return Direction != FIntVector2D();
+}
+
+float URancFlowField::GetCostToGoal(FIntVector2D Cell) const
+{
+	if (!Grid.IsValidCell(Cell) || Integration.Num() != Grid.Num())
+	{
+		return -1.f;
+	}
+
+	const float Cost = Integration[Grid.ToIndex(Cell)];
+	return Cost == Unreachable ? -1.f : Cost;
+}
+
+const FRancCostGrid& URancFlowField::GetGrid() const
+{
+	return Grid;
+}
+
+void URancFlowField::RecomputeFromNeighbours(int32 Index)
+{
+	if (Grid.Costs[Index] == 0)
+	{
+		return;
+	}
+
+	const int32 X = Index % Grid.Width;
+	const int32 Y = Index / Grid.Width;
+	float BestCost = Unreachable;
+	int32 BestDirection = INDEX_NONE;
+	for (int32 Direction = 0; Direction < 8; ++Direction)
+	{
+		if (!Grid.CanStep(X, Y, Direction))
+		{
+			continue;
+		}
+
+		const int32 NeighborIndex = Grid.ToIndex(X + RancGrid::DirX[Direction], Y + RancGrid::DirY[Direction]);
+		if (Integration[NeighborIndex] == Unreachable)
+		{
+			continue;
+		}
+
+		const float Cost = Integration[NeighborIndex] + Grid.Costs[NeighborIndex] * StepLength(Direction);
+		if (Cost < BestCost)
+		{
+			BestCost = Cost;
+			BestDirection = Direction;
+		}
+	}
+
+	if (BestDirection != INDEX_NONE && BestCost < Integration[Index])
+	{
+		Integration[Index] = BestCost;
+		Directions[Index] = static_cast<int8>(BestDirection);
+		QueueCell(Index);
+	}
+}
+
+void URancFlowField::InvalidateSubtree(int32 Index)
+{
+	if (InvalidatedMask[Index])
+	{
+		return;
+	}
+
+	auto Invalidate = [this](int32 CellIndex)
+	{
+		InvalidatedMask[CellIndex] = true;
+		Invalidated.Add(CellIndex);
+		Integration[CellIndex] = Unreachable;
+		Directions[CellIndex] = INDEX_NONE;
+	};
+
+	// Breadth first over the cells whose direction points at an invalidated cell, using Invalidated as the queue
+	int32 Cursor = Invalidated.Num();
+	Invalidate(Index);
+	while (Cursor < Invalidated.Num())
+	{
+		const FIntVector2D Cell = Grid.ToCell(Invalidated[Cursor++]);
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			const int32 NeighborX = Cell.X + RancGrid::DirX[Direction];
+			const int32 NeighborY = Cell.Y + RancGrid::DirY[Direction];
+			if (!Grid.IsValidCell(NeighborX, NeighborY))
+			{
+				continue;
+			}
+
+			const int32 NeighborIndex = Grid.ToIndex(NeighborX, NeighborY);
+			if (!InvalidatedMask[NeighborIndex] && Directions[NeighborIndex] == RancGrid::OppositeDirection[Direction])
+			{
+				Invalidate(NeighborIndex);
+			}
+		}
+	}
+}
+
+void URancFlowField::QueueCell(int32 Index)
+{
+	if (QueueHandles[Index] == INDEX_NONE)
+	{
+		QueueHandles[Index] = Queue.Push(Index, Integration[Index]);
+	}
+	else
+	{
+		Queue.UpdateCost(QueueHandles[Index], Integration[Index]);
+	}
+}
+
+void URancFlowField::Propagate()
+{
+	int32 Index;
+	float Cost;
+	while (Queue.TryPop(Index, Cost))
+	{
+		QueueHandles[Index] = INDEX_NONE;
+
+		const int32 X = Index % Grid.Width;
+		const int32 Y = Index / Grid.Width;
+		const float EnterCost = Grid.Costs[Index];
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			// The corner rule is symmetric, so a neighbour can step back into this cell if this cell can step to it
+			if (!Grid.CanStep(X, Y, Direction))
+			{
+				continue;
+			}
+
+			const int32 NeighborIndex = Grid.ToIndex(X + RancGrid::DirX[Direction], Y + RancGrid::DirY[Direction]);
+			const float NewCost = Integration[Index] + EnterCost * StepLength(Direction);
+			if (NewCost < Integration[NeighborIndex])
+			{
+				Integration[NeighborIndex] = NewCost;
+				Directions[NeighborIndex] = static_cast<int8>(RancGrid::OppositeDirection[Direction]);
+				QueueCell(NeighborIndex);
+			}
+		}
+	}
+}
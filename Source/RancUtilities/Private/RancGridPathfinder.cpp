@@ -0,0 +1,429 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "RancGridPathfinder.h"
+
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+using RancGrid::DirX;
+using RancGrid::DirY;
+using RancGrid::Sqrt2;
+
+URancGridPathfinder* URancGridPathfinder::CreateGridPathfinder(UObject* Outer, int32 Width, int32 Height)
+{
+	URancGridPathfinder* Pathfinder = NewObject<URancGridPathfinder>(Outer ? Outer : GetTransientPackage());
+	Pathfinder->Grid.Init(Width, Height);
+	return Pathfinder;
+}
+
+void URancGridPathfinder::SetGrid(const FRancCostGrid& InGrid)
+{
+	if (InGrid.Costs.Num() != InGrid.Width * InGrid.Height)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SetGrid: Costs has %d entries but the grid is %dx%d."), InGrid.Costs.Num(), InGrid.Width, InGrid.Height);
+		return;
+	}
+
+	Grid = InGrid;
+	NumWeightedCells = 0;
+	for (const uint8 Cost : Grid.Costs)
+	{
+		NumWeightedCells += Cost > 1 ? 1 : 0;
+	}
+}
+
+void URancGridPathfinder::SetCellCost(FIntVector2D Cell, uint8 Cost)
+{
+	if (!Grid.IsValidCell(Cell))
+	{
+		return;
+	}
+
+	uint8& CellCost = Grid.Costs[Grid.ToIndex(Cell)];
+	NumWeightedCells += (Cost > 1 ? 1 : 0) - (CellCost > 1 ? 1 : 0);
+	CellCost = Cost;
+}
+
+const FRancCostGrid& URancGridPathfinder::GetGrid() const
+{
+	return Grid;
+}
+
+bool URancGridPathfinder::FindPath(FIntVector2D Start, FIntVector2D Goal, TArray<FIntVector2D>& OutPath)
+{
+	return FindPathWithScratch(Start, Goal, OutPath, GameThreadScratch);
+}
+
+void URancGridPathfinder::FindPaths(const TArray<FIntVector2D>& Starts, const TArray<FIntVector2D>& Goals, TArray<FRancGridPath>& OutPaths)
+{
+	if (Starts.Num() != Goals.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FindPaths: Starts and Goals should have the same length (%d vs %d)."), Starts.Num(), Goals.Num());
+	}
+
+	const int32 NumQueries = FMath::Min(Starts.Num(), Goals.Num());
+	OutPaths.Reset();
+	OutPaths.SetNum(NumQueries);
+	if (NumQueries == 0)
+	{
+		return;
+	}
+
+	const int32 NumWorkers = FMath::Min(FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, NumQueries);
+	if (WorkerScratch.Num() < NumWorkers)
+	{
+		WorkerScratch.SetNum(NumWorkers);
+	}
+
+	// Workers pull queries one at a time so a few long paths don't leave the other workers idle
+	std::atomic<int32> NextQuery(0);
+	ParallelFor(NumWorkers, [&](int32 WorkerIndex)
+	{
+		FRancGridSearchScratch& Scratch = WorkerScratch[WorkerIndex];
+		for (int32 Query = NextQuery++; Query < NumQueries; Query = NextQuery++)
+		{
+			FRancGridPath& Path = OutPaths[Query];
+			Path.bFound = FindPathWithScratch(Starts[Query], Goals[Query], Path.Cells, Scratch);
+		}
+	});
+}
+
+bool URancGridPathfinder::FindPathWithScratch(const FIntVector2D& Start, const FIntVector2D& Goal, TArray<FIntVector2D>& OutPath, FRancGridSearchScratch& Scratch) const
+{
+	OutPath.Reset();
+	if (!Grid.IsValid() || !Grid.IsWalkable(Start) || !Grid.IsWalkable(Goal))
+	{
+		return false;
+	}
+
+	const int32 StartIndex = Grid.ToIndex(Start);
+	const int32 GoalIndex = Grid.ToIndex(Goal);
+	Scratch.BeginSearch(Grid.Num());
+
+	const bool bUseJumpPointSearch = Algorithm == ERancPathfindingAlgorithm::JumpPointSearch && bAllowDiagonal && NumWeightedCells == 0;
+	const bool bFound = bUseJumpPointSearch
+		? RunJumpPointSearch(StartIndex, GoalIndex, Scratch)
+		: RunAStar(StartIndex, GoalIndex, Scratch);
+
+	if (bFound)
+	{
+		BuildPath(GoalIndex, Scratch, OutPath);
+	}
+	return bFound;
+}
+
+bool URancGridPathfinder::RunAStar(int32 StartIndex, int32 GoalIndex, FRancGridSearchScratch& Scratch) const
+{
+	using FNodeState = FRancGridSearchScratch::FNodeState;
+	const int32 NumDirections = bAllowDiagonal ? 8 : 4;
+
+	FNodeState& StartNode = Scratch.Touch(StartIndex);
+	StartNode.G = 0.f;
+	StartNode.OpenHandle = Scratch.Open.Push(StartIndex, Heuristic(StartIndex, GoalIndex));
+
+	while (!Scratch.Open.IsEmpty())
+	{
+		const int32 CurrentIndex = Scratch.Open.Pop();
+		FNodeState& Current = Scratch.Nodes[CurrentIndex];
+		Current.OpenHandle = FRancGridSearchScratch::ClosedHandle;
+		if (CurrentIndex == GoalIndex)
+		{
+			return true;
+		}
+
+		const int32 X = CurrentIndex % Grid.Width;
+		const int32 Y = CurrentIndex / Grid.Width;
+		for (int32 Direction = 0; Direction < NumDirections; ++Direction)
+		{
+			const int32 NeighborX = X + DirX[Direction];
+			const int32 NeighborY = Y + DirY[Direction];
+			const uint8 Cost = Grid.GetCost(NeighborX, NeighborY);
+			if (Cost == 0)
+			{
+				continue;
+			}
+
+			const bool bDiagonal = Direction >= 4;
+			if (bDiagonal && (!Grid.IsWalkable(NeighborX, Y) || !Grid.IsWalkable(X, NeighborY)))
+			{
+				// Don't cut blocked corners
+				continue;
+			}
+
+			const int32 NeighborIndex = Grid.ToIndex(NeighborX, NeighborY);
+			FNodeState& Neighbor = Scratch.Touch(NeighborIndex);
+			if (Neighbor.OpenHandle == FRancGridSearchScratch::ClosedHandle)
+			{
+				continue;
+			}
+
+			const float G = Current.G + Cost * (bDiagonal ? Sqrt2 : 1.f);
+			if (G >= Neighbor.G)
+			{
+				continue;
+			}
+
+			Neighbor.G = G;
+			Neighbor.Parent = CurrentIndex;
+			const float F = G + Heuristic(NeighborIndex, GoalIndex);
+			if (Neighbor.OpenHandle == INDEX_NONE)
+			{
+				Neighbor.OpenHandle = Scratch.Open.Push(NeighborIndex, F);
+			}
+			else
+			{
+				Scratch.Open.UpdateCost(Neighbor.OpenHandle, F);
+			}
+		}
+	}
+
+	return false;
+}
+
+bool URancGridPathfinder::RunJumpPointSearch(int32 StartIndex, int32 GoalIndex, FRancGridSearchScratch& Scratch) const
+{
+	// Jump Point Search for 8-connected uniform grids without corner cutting. Straight moves are expanded
+	// through every walkable side cell, since without corner cutting those can't be reached diagonally.
+	using FNodeState = FRancGridSearchScratch::FNodeState;
+
+	FNodeState& StartNode = Scratch.Touch(StartIndex);
+	StartNode.G = 0.f;
+	StartNode.OpenHandle = Scratch.Open.Push(StartIndex, Heuristic(StartIndex, GoalIndex));
+
+	while (!Scratch.Open.IsEmpty())
+	{
+		const int32 CurrentIndex = Scratch.Open.Pop();
+		FNodeState& Current = Scratch.Nodes[CurrentIndex];
+		Current.OpenHandle = FRancGridSearchScratch::ClosedHandle;
+		if (CurrentIndex == GoalIndex)
+		{
+			return true;
+		}
+
+		const int32 X = CurrentIndex % Grid.Width;
+		const int32 Y = CurrentIndex / Grid.Width;
+
+		int32 NumSearchDirections = 0;
+		int32 SearchDirX[8];
+		int32 SearchDirY[8];
+		auto AddDirection = [&](int32 DX, int32 DY)
+		{
+			SearchDirX[NumSearchDirections] = DX;
+			SearchDirY[NumSearchDirections] = DY;
+			++NumSearchDirections;
+		};
+
+		if (Current.Parent == INDEX_NONE)
+		{
+			for (int32 Direction = 0; Direction < 8; ++Direction)
+			{
+				const int32 DX = DirX[Direction];
+				const int32 DY = DirY[Direction];
+				if (Grid.IsWalkable(X + DX, Y + DY) && (Direction < 4 || (Grid.IsWalkable(X + DX, Y) && Grid.IsWalkable(X, Y + DY))))
+				{
+					AddDirection(DX, DY);
+				}
+			}
+		}
+		else
+		{
+			const FIntVector2D ParentCell = Grid.ToCell(Current.Parent);
+			const int32 DX = FMath::Sign(X - ParentCell.X);
+			const int32 DY = FMath::Sign(Y - ParentCell.Y);
+
+			if (DX != 0 && DY != 0)
+			{
+				const bool bVerticalWalkable = Grid.IsWalkable(X, Y + DY);
+				const bool bHorizontalWalkable = Grid.IsWalkable(X + DX, Y);
+				if (bVerticalWalkable)
+				{
+					AddDirection(0, DY);
+				}
+				if (bHorizontalWalkable)
+				{
+					AddDirection(DX, 0);
+				}
+				if (bVerticalWalkable && bHorizontalWalkable && Grid.IsWalkable(X + DX, Y + DY))
+				{
+					AddDirection(DX, DY);
+				}
+			}
+			else if (DX != 0)
+			{
+				const bool bNextWalkable = Grid.IsWalkable(X + DX, Y);
+				const bool bUpWalkable = Grid.IsWalkable(X, Y + 1);
+				const bool bDownWalkable = Grid.IsWalkable(X, Y - 1);
+				if (bNextWalkable)
+				{
+					AddDirection(DX, 0);
+					if (bUpWalkable && Grid.IsWalkable(X + DX, Y + 1))
+					{
+						AddDirection(DX, 1);
+					}
+					if (bDownWalkable && Grid.IsWalkable(X + DX, Y - 1))
+					{
+						AddDirection(DX, -1);
+					}
+				}
+				if (bUpWalkable)
+				{
+					AddDirection(0, 1);
+				}
+				if (bDownWalkable)
+				{
+					AddDirection(0, -1);
+				}
+			}
+			else
+			{
+				const bool bNextWalkable = Grid.IsWalkable(X, Y + DY);
+				const bool bRightWalkable = Grid.IsWalkable(X + 1, Y);
+				const bool bLeftWalkable = Grid.IsWalkable(X - 1, Y);
+				if (bNextWalkable)
+				{
+					AddDirection(0, DY);
+					if (bRightWalkable && Grid.IsWalkable(X + 1, Y + DY))
+					{
+						AddDirection(1, DY);
+					}
+					if (bLeftWalkable && Grid.IsWalkable(X - 1, Y + DY))
+					{
+						AddDirection(-1, DY);
+					}
+				}
+				if (bRightWalkable)
+				{
+					AddDirection(1, 0);
+				}
+				if (bLeftWalkable)
+				{
+					AddDirection(-1, 0);
+				}
+			}
+		}
+
+		for (int32 i = 0; i < NumSearchDirections; ++i)
+		{
+			const int32 JumpIndex = Jump(X + SearchDirX[i], Y + SearchDirY[i], SearchDirX[i], SearchDirY[i], GoalIndex);
+			if (JumpIndex == INDEX_NONE)
+			{
+				continue;
+			}
+
+			FNodeState& JumpNode = Scratch.Touch(JumpIndex);
+			if (JumpNode.OpenHandle == FRancGridSearchScratch::ClosedHandle)
+			{
+				continue;
+			}
+
+			// Every cell costs 1 here, so the jump costs the octile distance
+			const float G = Current.G + Heuristic(CurrentIndex, JumpIndex);
+			if (G >= JumpNode.G)
+			{
+				continue;
+			}
+
+			JumpNode.G = G;
+			JumpNode.Parent = CurrentIndex;
+			const float F = G + Heuristic(JumpIndex, GoalIndex);
+			if (JumpNode.OpenHandle == INDEX_NONE)
+			{
+				JumpNode.OpenHandle = Scratch.Open.Push(JumpIndex, F);
+			}
+			else
+			{
+				Scratch.Open.UpdateCost(JumpNode.OpenHandle, F);
+			}
+		}
+	}
+
+	return false;
+}
+
+int32 URancGridPathfinder::Jump(int32 X, int32 Y, int32 DX, int32 DY, int32 GoalIndex) const
+{
+	while (true)
+	{
+		if (!Grid.IsWalkable(X, Y))
+		{
+			return INDEX_NONE;
+		}
+
+		const int32 Index = Grid.ToIndex(X, Y);
+		if (Index == GoalIndex)
+		{
+			return Index;
+		}
+
+		if (DX != 0 && DY != 0)
+		{
+			// A diagonal step is a jump point if either straight component leads to one
+			if (Jump(X + DX, Y, DX, 0, GoalIndex) != INDEX_NONE || Jump(X, Y + DY, 0, DY, GoalIndex) != INDEX_NONE)
+			{
+				return Index;
+			}
+		}
+		else if (DX != 0)
+		{
+			// Forced neighbour: a side cell that opens up right after a wall behind us
+			if ((Grid.IsWalkable(X, Y - 1) && !Grid.IsWalkable(X - DX, Y - 1)) ||
+				(Grid.IsWalkable(X, Y + 1) && !Grid.IsWalkable(X - DX, Y + 1)))
+			{
+				return Index;
+			}
+		}
+		else
+		{
+			if ((Grid.IsWalkable(X - 1, Y) && !Grid.IsWalkable(X - 1, Y - DY)) ||
+				(Grid.IsWalkable(X + 1, Y) && !Grid.IsWalkable(X + 1, Y - DY)))
+			{
+				return Index;
+			}
+		}
+
+		// Diagonal steps need both straight neighbours open, for straight steps this only checks the next cell
+		if (!Grid.IsWalkable(X + DX, Y) || !Grid.IsWalkable(X, Y + DY))
+		{
+			return INDEX_NONE;
+		}
+
+		X += DX;
+		Y += DY;
+	}
+}
+
+float URancGridPathfinder::Heuristic(int32 FromIndex, int32 ToIndex) const
+{
+	const int32 DX = FMath::Abs(FromIndex % Grid.Width - ToIndex % Grid.Width);
+	const int32 DY = FMath::Abs(FromIndex / Grid.Width - ToIndex / Grid.Width);
+	if (!bAllowDiagonal)
+	{
+		return static_cast<float>(DX + DY);
+	}
+
+	// Octile distance, admissible since every cell costs at least 1
+	return FMath::Max(DX, DY) + (Sqrt2 - 1.f) * FMath::Min(DX, DY);
+}
+
+void URancGridPathfinder::BuildPath(int32 GoalIndex, const FRancGridSearchScratch& Scratch, TArray<FIntVector2D>& OutPath) const
+{
+	OutPath.Reset();
+	for (int32 Index = GoalIndex; Index != INDEX_NONE; Index = Scratch.Nodes[Index].Parent)
+	{
+		const FIntVector2D Cell = Grid.ToCell(Index);
+		if (OutPath.Num() > 0)
+		{
+			// Fill in the cells skipped by a jump, jumps are always straight or 45 degree diagonal lines
+			const FIntVector2D Previous = OutPath.Last();
+			const FIntVector2D Step(FMath::Sign(Cell.X - Previous.X), FMath::Sign(Cell.Y - Previous.Y));
+			for (FIntVector2D Between = Previous + Step; Between != Cell; Between += Step)
+			{
+				OutPath.Add(Between);
+			}
+		}
+		OutPath.Add(Cell);
+	}
+
+	Algo::Reverse(OutPath);
+}
@@ -0,0 +1,582 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "RancHierarchicalPathfinder.h"
+
+#include "Algo/Reverse.h"
+
+namespace
+{
+	constexpr float Unreachable = TNumericLimits<float>::Max();
+	constexpr int32 ClosedHandle = -2;
+
+	// Border openings at least this wide get an entrance at each end instead of one in the middle
+	constexpr int32 WideEntranceLength = 6;
+}
+
+URancHierarchicalPathfinder* URancHierarchicalPathfinder::CreateHierarchicalPathfinder(UObject* Outer, const FRancCostGrid& Grid, int32 ClusterSize)
+{
+	URancHierarchicalPathfinder* Pathfinder = NewObject<URancHierarchicalPathfinder>(Outer ? Outer : GetTransientPackage());
+	Pathfinder->Build(Grid, ClusterSize);
+	return Pathfinder;
+}
+
+void URancHierarchicalPathfinder::Build(const FRancCostGrid& InGrid, int32 InClusterSize)
+{
+	if (InGrid.Costs.Num() != InGrid.Width * InGrid.Height)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Build: Costs has %d entries but the grid is %dx%d."), InGrid.Costs.Num(), InGrid.Width, InGrid.Height);
+		return;
+	}
+
+	Grid = InGrid;
+	ClusterSize = FMath::Max(InClusterSize, 2);
+	NumClustersX = FMath::DivideAndRoundUp(Grid.Width, ClusterSize);
+	NumClustersY = FMath::DivideAndRoundUp(Grid.Height, ClusterSize);
+	const int32 NumClusters = NumClustersX * NumClustersY;
+
+	Nodes.Reset();
+	FreeNodes.Reset();
+	CellToNode.Reset();
+	ClusterNodes.Reset();
+	ClusterNodes.SetNum(NumClusters);
+	Borders.Reset();
+	Borders.SetNum(NumClusters * 2);
+
+	for (int32 BorderIndex = 0; BorderIndex < Borders.Num(); ++BorderIndex)
+	{
+		BuildBorder(BorderIndex);
+	}
+	for (int32 ClusterIndex = 0; ClusterIndex < NumClusters; ++ClusterIndex)
+	{
+		BuildIntraEdges(ClusterIndex);
+	}
+}
+
+void URancHierarchicalPathfinder::SetCellCost(FIntVector2D Cell, uint8 Cost)
+{
+	SetCellCosts({Cell}, {Cost});
+}
+
+void URancHierarchicalPathfinder::SetCellCosts(const TArray<FIntVector2D>& Cells, const TArray<uint8>& Costs)
+{
+	if (Cells.Num() != Costs.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SetCellCosts: Cells and Costs must have the same length (%d vs %d)."), Cells.Num(), Costs.Num());
+		return;
+	}
+
+	TArray<int32> DirtyClusters;
+	for (int32 i = 0; i < Cells.Num(); ++i)
+	{
+		if (!Grid.IsValidCell(Cells[i]))
+		{
+			continue;
+		}
+
+		uint8& CellCost = Grid.Costs[Grid.ToIndex(Cells[i])];
+		if (CellCost != Costs[i])
+		{
+			CellCost = Costs[i];
+			DirtyClusters.AddUnique(GetClusterIndex(Cells[i].X, Cells[i].Y));
+		}
+	}
+
+	if (!DirtyClusters.IsEmpty())
+	{
+		RebuildClusters(DirtyClusters);
+	}
+}
+
+bool URancHierarchicalPathfinder::FindPath(FIntVector2D Start, FIntVector2D Goal, FRancHierarchicalPath& OutPath, int32 NumClustersToRefine)
+{
+	OutPath = FRancHierarchicalPath();
+	if (!Grid.IsValid() || ClusterNodes.IsEmpty() || !Grid.IsWalkable(Start) || !Grid.IsWalkable(Goal))
+	{
+		return false;
+	}
+
+	const int32 StartCell = Grid.ToIndex(Start);
+	const int32 GoalCell = Grid.ToIndex(Goal);
+	const int32 StartCluster = GetClusterIndex(Start.X, Start.Y);
+	const int32 GoalCluster = GetClusterIndex(Goal.X, Goal.Y);
+
+	// Start and goal join the abstract graph as two temporary nodes after the real ones
+	const int32 VirtualGoal = Nodes.Num();
+	const int32 VirtualStart = Nodes.Num() + 1;
+
+	TArray<FAbstractEdge, TInlineAllocator<32>> StartEdges;
+	RunClusterSearch(StartCluster, StartCell, INDEX_NONE, false);
+	for (const int32 NodeIndex : ClusterNodes[StartCluster])
+	{
+		const float Cost = GetClusterSearchCost(Nodes[NodeIndex].CellIndex);
+		if (Cost != Unreachable)
+		{
+			StartEdges.Add({NodeIndex, Cost});
+		}
+	}
+	if (StartCluster == GoalCluster && GetClusterSearchCost(GoalCell) != Unreachable)
+	{
+		StartEdges.Add({VirtualGoal, GetClusterSearchCost(GoalCell)});
+	}
+
+	TMap<int32, float, TInlineSetAllocator<32>> GoalEdgeCosts;
+	RunClusterSearch(GoalCluster, GoalCell, INDEX_NONE, true);
+	for (const int32 NodeIndex : ClusterNodes[GoalCluster])
+	{
+		const float Cost = GetClusterSearchCost(Nodes[NodeIndex].CellIndex);
+		if (Cost != Unreachable)
+		{
+			GoalEdgeCosts.Add(NodeIndex, Cost);
+		}
+	}
+
+	auto GetCell = [&](int32 NodeIndex)
+	{
+		return NodeIndex == VirtualStart ? StartCell : NodeIndex == VirtualGoal ? GoalCell : Nodes[NodeIndex].CellIndex;
+	};
+
+	const int32 NumSearchNodes = Nodes.Num() + 2;
+	AbstractCosts.Init(Unreachable, NumSearchNodes);
+	AbstractParents.Init(INDEX_NONE, NumSearchNodes);
+	AbstractHandles.Init(INDEX_NONE, NumSearchNodes);
+	AbstractOpen.Reset();
+
+	auto Relax = [&](int32 FromNode, int32 ToNode, float EdgeCost)
+	{
+		if (AbstractHandles[ToNode] == ClosedHandle)
+		{
+			return;
+		}
+
+		const float Cost = AbstractCosts[FromNode] + EdgeCost;
+		if (Cost >= AbstractCosts[ToNode])
+		{
+			return;
+		}
+
+		AbstractCosts[ToNode] = Cost;
+		AbstractParents[ToNode] = FromNode;
+		const float Estimate = Cost + OctileDistance(GetCell(ToNode), GoalCell);
+		if (AbstractHandles[ToNode] == INDEX_NONE)
+		{
+			AbstractHandles[ToNode] = AbstractOpen.Push(ToNode, Estimate);
+		}
+		else
+		{
+			AbstractOpen.UpdateCost(AbstractHandles[ToNode], Estimate);
+		}
+	};
+
+	AbstractCosts[VirtualStart] = 0.f;
+	AbstractHandles[VirtualStart] = AbstractOpen.Push(VirtualStart, OctileDistance(StartCell, GoalCell));
+
+	bool bFound = false;
+	while (!AbstractOpen.IsEmpty())
+	{
+		const int32 Current = AbstractOpen.Pop();
+		AbstractHandles[Current] = ClosedHandle;
+		if (Current == VirtualGoal)
+		{
+			bFound = true;
+			break;
+		}
+
+		if (Current == VirtualStart)
+		{
+			for (const FAbstractEdge& Edge : StartEdges)
+			{
+				Relax(Current, Edge.ToNode, Edge.Cost);
+			}
+			continue;
+		}
+
+		const FAbstractNode& Node = Nodes[Current];
+		for (const FAbstractEdge& Edge : Node.IntraEdges)
+		{
+			Relax(Current, Edge.ToNode, Edge.Cost);
+		}
+		for (const FAbstractEdge& Edge : Node.InterEdges)
+		{
+			Relax(Current, Edge.ToNode, Edge.Cost);
+		}
+		if (const float* GoalCost = GoalEdgeCosts.Find(Current))
+		{
+			Relax(Current, VirtualGoal, *GoalCost);
+		}
+	}
+
+	if (!bFound)
+	{
+		return false;
+	}
+
+	for (int32 NodeIndex = VirtualGoal; NodeIndex != INDEX_NONE; NodeIndex = AbstractParents[NodeIndex])
+	{
+		const FIntVector2D Cell = Grid.ToCell(GetCell(NodeIndex));
+		// The start or goal can coincide with an entrance
+		if (OutPath.Waypoints.IsEmpty() || OutPath.Waypoints.Last() != Cell)
+		{
+			OutPath.Waypoints.Add(Cell);
+		}
+	}
+	Algo::Reverse(OutPath.Waypoints);
+
+	OutPath.Cells.Add(Start);
+	OutPath.NextWaypoint = 1;
+	return RefinePath(OutPath, NumClustersToRefine);
+}
+
+bool URancHierarchicalPathfinder::RefinePath(FRancHierarchicalPath& Path, int32 NumClusters)
+{
+	int32 NumRefinedClusters = 0;
+	while (!Path.IsFullyRefined() && (NumClusters <= 0 || NumRefinedClusters < NumClusters))
+	{
+		if (Path.NextWaypoint <= 0)
+		{
+			return false;
+		}
+
+		const FIntVector2D From = Path.Waypoints[Path.NextWaypoint - 1];
+		const FIntVector2D To = Path.Waypoints[Path.NextWaypoint];
+		if (!Grid.IsWalkable(From) || !Grid.IsWalkable(To))
+		{
+			return false;
+		}
+
+		const int32 FromCluster = GetClusterIndex(From.X, From.Y);
+		if (FromCluster != GetClusterIndex(To.X, To.Y))
+		{
+			// Waypoints in different clusters are the two sides of a border transition
+			Path.Cells.Add(To);
+		}
+		else
+		{
+			if (!RunClusterSearch(FromCluster, Grid.ToIndex(From), Grid.ToIndex(To), false))
+			{
+				return false;
+			}
+
+			const int32 FirstNewCell = Path.Cells.Num();
+			const FClusterBounds& Bounds = ClusterSearch.Bounds;
+			for (int32 Local = Bounds.ToLocal(To.X, To.Y); ClusterSearch.Parents[Local] != INDEX_NONE; Local = ClusterSearch.Parents[Local])
+			{
+				Path.Cells.Add(FIntVector2D(Bounds.MinX + Local % Bounds.SizeX, Bounds.MinY + Local / Bounds.SizeX));
+			}
+			Algo::Reverse(Path.Cells.GetData() + FirstNewCell, Path.Cells.Num() - FirstNewCell);
+			++NumRefinedClusters;
+		}
+
+		++Path.NextWaypoint;
+	}
+
+	return true;
+}
+
+const FRancCostGrid& URancHierarchicalPathfinder::GetGrid() const
+{
+	return Grid;
+}
+
+int32 URancHierarchicalPathfinder::GetNumAbstractNodes() const
+{
+	return CellToNode.Num();
+}
+
+int32 URancHierarchicalPathfinder::GetClusterIndex(int32 X, int32 Y) const
+{
+	return (Y / ClusterSize) * NumClustersX + X / ClusterSize;
+}
+
+URancHierarchicalPathfinder::FClusterBounds URancHierarchicalPathfinder::GetClusterBounds(int32 ClusterIndex) const
+{
+	FClusterBounds Bounds;
+	Bounds.MinX = (ClusterIndex % NumClustersX) * ClusterSize;
+	Bounds.MinY = (ClusterIndex / NumClustersX) * ClusterSize;
+	Bounds.SizeX = FMath::Min(ClusterSize, Grid.Width - Bounds.MinX);
+	Bounds.SizeY = FMath::Min(ClusterSize, Grid.Height - Bounds.MinY);
+	return Bounds;
+}
+
+void URancHierarchicalPathfinder::RebuildClusters(const TArray<int32>& DirtyClusters)
+{
+	TArray<int32> DirtyBorders;
+	TArray<int32> RouteClusters;
+	for (const int32 ClusterIndex : DirtyClusters)
+	{
+		const int32 ClusterX = ClusterIndex % NumClustersX;
+		const int32 ClusterY = ClusterIndex / NumClustersX;
+
+		// Each cluster owns its east and north border, the west and south ones belong to the neighbours
+		DirtyBorders.AddUnique(ClusterIndex * 2);
+		DirtyBorders.AddUnique(ClusterIndex * 2 + 1);
+		RouteClusters.AddUnique(ClusterIndex);
+		if (ClusterX > 0)
+		{
+			DirtyBorders.AddUnique((ClusterIndex - 1) * 2);
+			RouteClusters.AddUnique(ClusterIndex - 1);
+		}
+		if (ClusterY > 0)
+		{
+			DirtyBorders.AddUnique((ClusterIndex - NumClustersX) * 2 + 1);
+			RouteClusters.AddUnique(ClusterIndex - NumClustersX);
+		}
+		if (ClusterX + 1 < NumClustersX)
+		{
+			RouteClusters.AddUnique(ClusterIndex + 1);
+		}
+		if (ClusterY + 1 < NumClustersY)
+		{
+			RouteClusters.AddUnique(ClusterIndex + NumClustersX);
+		}
+	}
+
+	// Clear every border first so entrance cells shared by two borders are only released once both are gone
+	for (const int32 BorderIndex : DirtyBorders)
+	{
+		ClearBorder(BorderIndex);
+	}
+	for (const int32 BorderIndex : DirtyBorders)
+	{
+		BuildBorder(BorderIndex);
+	}
+	for (const int32 ClusterIndex : RouteClusters)
+	{
+		BuildIntraEdges(ClusterIndex);
+	}
+}
+
+void URancHierarchicalPathfinder::ClearBorder(int32 BorderIndex)
+{
+	for (const FTransition& Transition : Borders[BorderIndex])
+	{
+		Nodes[Transition.NodeA].InterEdges.RemoveAllSwap([&](const FAbstractEdge& Edge) { return Edge.ToNode == Transition.NodeB; });
+		Nodes[Transition.NodeB].InterEdges.RemoveAllSwap([&](const FAbstractEdge& Edge) { return Edge.ToNode == Transition.NodeA; });
+		ReleaseNode(Transition.NodeA);
+		ReleaseNode(Transition.NodeB);
+	}
+	Borders[BorderIndex].Reset();
+}
+
+void URancHierarchicalPathfinder::BuildBorder(int32 BorderIndex)
+{
+	const int32 ClusterIndex = BorderIndex / 2;
+	const bool bEastBorder = BorderIndex % 2 == 0;
+	const int32 ClusterX = ClusterIndex % NumClustersX;
+	const int32 ClusterY = ClusterIndex / NumClustersX;
+	if ((bEastBorder && ClusterX + 1 >= NumClustersX) || (!bEastBorder && ClusterY + 1 >= NumClustersY))
+	{
+		return;
+	}
+
+	const FClusterBounds Bounds = GetClusterBounds(ClusterIndex);
+	const int32 Length = bEastBorder ? Bounds.SizeY : Bounds.SizeX;
+
+	// Cell Offset along the border, on this side and on the neighbour's side
+	auto GetCells = [&](int32 Offset, FIntVector2D& OutInside, FIntVector2D& OutOutside)
+	{
+		if (bEastBorder)
+		{
+			OutInside = FIntVector2D(Bounds.MinX + Bounds.SizeX - 1, Bounds.MinY + Offset);
+			OutOutside = FIntVector2D(OutInside.X + 1, OutInside.Y);
+		}
+		else
+		{
+			OutInside = FIntVector2D(Bounds.MinX + Offset, Bounds.MinY + Bounds.SizeY - 1);
+			OutOutside = FIntVector2D(OutInside.X, OutInside.Y + 1);
+		}
+	};
+
+	auto AddEntrance = [&](int32 Offset)
+	{
+		FIntVector2D Inside, Outside;
+		GetCells(Offset, Inside, Outside);
+		AddTransition(BorderIndex, Grid.ToIndex(Inside), Grid.ToIndex(Outside));
+	};
+
+	// Split the border into openings where both sides are walkable
+	int32 OpeningStart = INDEX_NONE;
+	for (int32 Offset = 0; Offset <= Length; ++Offset)
+	{
+		bool bOpen = false;
+		if (Offset < Length)
+		{
+			FIntVector2D Inside, Outside;
+			GetCells(Offset, Inside, Outside);
+			bOpen = Grid.IsWalkable(Inside) && Grid.IsWalkable(Outside);
+		}
+
+		if (bOpen && OpeningStart == INDEX_NONE)
+		{
+			OpeningStart = Offset;
+		}
+		else if (!bOpen && OpeningStart != INDEX_NONE)
+		{
+			const int32 OpeningEnd = Offset - 1;
+			if (OpeningEnd - OpeningStart + 1 >= WideEntranceLength)
+			{
+				AddEntrance(OpeningStart);
+				AddEntrance(OpeningEnd);
+			}
+			else
+			{
+				AddEntrance((OpeningStart + OpeningEnd) / 2);
+			}
+			OpeningStart = INDEX_NONE;
+		}
+	}
+}
+
+void URancHierarchicalPathfinder::AddTransition(int32 BorderIndex, int32 CellA, int32 CellB)
+{
+	const int32 NodeA = GetOrCreateNode(CellA);
+	const int32 NodeB = GetOrCreateNode(CellB);
+	Nodes[NodeA].InterEdges.Add({NodeB, static_cast<float>(Grid.Costs[CellB])});
+	Nodes[NodeB].InterEdges.Add({NodeA, static_cast<float>(Grid.Costs[CellA])});
+	Borders[BorderIndex].Add({NodeA, NodeB});
+}
+
+int32 URancHierarchicalPathfinder::GetOrCreateNode(int32 CellIndex)
+{
+	int32 NodeIndex;
+	if (const int32* ExistingNode = CellToNode.Find(CellIndex))
+	{
+		NodeIndex = *ExistingNode;
+	}
+	else
+	{
+		NodeIndex = FreeNodes.IsEmpty() ? Nodes.AddDefaulted() : FreeNodes.Pop(EAllowShrinking::No);
+		const FIntVector2D Cell = Grid.ToCell(CellIndex);
+		FAbstractNode& Node = Nodes[NodeIndex];
+		Node.CellIndex = CellIndex;
+		Node.ClusterIndex = GetClusterIndex(Cell.X, Cell.Y);
+		CellToNode.Add(CellIndex, NodeIndex);
+		ClusterNodes[Node.ClusterIndex].Add(NodeIndex);
+	}
+
+	++Nodes[NodeIndex].RefCount;
+	return NodeIndex;
+}
+
+void URancHierarchicalPathfinder::ReleaseNode(int32 NodeIndex)
+{
+	FAbstractNode& Node = Nodes[NodeIndex];
+	if (--Node.RefCount > 0)
+	{
+		return;
+	}
+
+	// Routes of the node's cluster are rebuilt by the caller, so no other node keeps an edge to it
+	CellToNode.Remove(Node.CellIndex);
+	ClusterNodes[Node.ClusterIndex].RemoveSingleSwap(NodeIndex);
+	Node.IntraEdges.Reset();
+	Node.InterEdges.Reset();
+	Node.CellIndex = INDEX_NONE;
+	Node.ClusterIndex = INDEX_NONE;
+	FreeNodes.Add(NodeIndex);
+}
+
+void URancHierarchicalPathfinder::BuildIntraEdges(int32 ClusterIndex)
+{
+	const TArray<int32>& NodesInCluster = ClusterNodes[ClusterIndex];
+	for (const int32 NodeIndex : NodesInCluster)
+	{
+		FAbstractNode& Node = Nodes[NodeIndex];
+		Node.IntraEdges.Reset();
+		RunClusterSearch(ClusterIndex, Node.CellIndex, INDEX_NONE, false);
+		for (const int32 OtherIndex : NodesInCluster)
+		{
+			const float Cost = GetClusterSearchCost(Nodes[OtherIndex].CellIndex);
+			if (OtherIndex != NodeIndex && Cost != Unreachable)
+			{
+				Node.IntraEdges.Add({OtherIndex, Cost});
+			}
+		}
+	}
+}
+
+bool URancHierarchicalPathfinder::RunClusterSearch(int32 ClusterIndex, int32 SourceCell, int32 GoalCell, bool bReverse)
+{
+	FClusterSearch& Search = ClusterSearch;
+	Search.Bounds = GetClusterBounds(ClusterIndex);
+	const FClusterBounds& Bounds = Search.Bounds;
+	const int32 NumLocalCells = Bounds.SizeX * Bounds.SizeY;
+	Search.Costs.Init(Unreachable, NumLocalCells);
+	Search.Parents.Init(INDEX_NONE, NumLocalCells);
+	Search.Handles.Init(INDEX_NONE, NumLocalCells);
+	Search.Open.Reset();
+
+	const FIntVector2D Source = Grid.ToCell(SourceCell);
+	const int32 SourceLocal = Bounds.ToLocal(Source.X, Source.Y);
+	int32 GoalLocal = INDEX_NONE;
+	if (GoalCell != INDEX_NONE)
+	{
+		const FIntVector2D Goal = Grid.ToCell(GoalCell);
+		GoalLocal = Bounds.ToLocal(Goal.X, Goal.Y);
+	}
+
+	Search.Costs[SourceLocal] = 0.f;
+	Search.Handles[SourceLocal] = Search.Open.Push(SourceLocal, GoalCell != INDEX_NONE ? OctileDistance(SourceCell, GoalCell) : 0.f);
+
+	while (!Search.Open.IsEmpty())
+	{
+		const int32 Local = Search.Open.Pop();
+		Search.Handles[Local] = ClosedHandle;
+		if (Local == GoalLocal)
+		{
+			return true;
+		}
+
+		const int32 X = Bounds.MinX + Local % Bounds.SizeX;
+		const int32 Y = Bounds.MinY + Local / Bounds.SizeX;
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			const int32 NeighborX = X + RancGrid::DirX[Direction];
+			const int32 NeighborY = Y + RancGrid::DirY[Direction];
+			if (!Bounds.Contains(NeighborX, NeighborY) || !Grid.CanStep(X, Y, Direction))
+			{
+				continue;
+			}
+
+			const int32 NeighborLocal = Bounds.ToLocal(NeighborX, NeighborY);
+			if (Search.Handles[NeighborLocal] == ClosedHandle)
+			{
+				continue;
+			}
+
+			// Forward searches pay for entering the neighbour, reverse searches for entering the current cell
+			const uint8 EnterCost = bReverse ? Grid.GetCost(X, Y) : Grid.GetCost(NeighborX, NeighborY);
+			const float Cost = Search.Costs[Local] + EnterCost * (RancGrid::IsDiagonal(Direction) ? RancGrid::Sqrt2 : 1.f);
+			if (Cost >= Search.Costs[NeighborLocal])
+			{
+				continue;
+			}
+
+			Search.Costs[NeighborLocal] = Cost;
+			Search.Parents[NeighborLocal] = Local;
+			const float Estimate = GoalCell != INDEX_NONE ? Cost + OctileDistance(Grid.ToIndex(NeighborX, NeighborY), GoalCell) : Cost;
+			if (Search.Handles[NeighborLocal] == INDEX_NONE)
+			{
+				Search.Handles[NeighborLocal] = Search.Open.Push(NeighborLocal, Estimate);
+			}
+			else
+			{
+				Search.Open.UpdateCost(Search.Handles[NeighborLocal], Estimate);
+			}
+		}
+	}
+
+	return GoalCell == INDEX_NONE;
+}
+
+float URancHierarchicalPathfinder::GetClusterSearchCost(int32 CellIndex) const
+{
+	const FIntVector2D Cell = Grid.ToCell(CellIndex);
+	return ClusterSearch.Costs[ClusterSearch.Bounds.ToLocal(Cell.X, Cell.Y)];
+}
+
+float URancHierarchicalPathfinder::OctileDistance(int32 CellA, int32 CellB) const
+{
+	const int32 DX = FMath::Abs(CellA % Grid.Width - CellB % Grid.Width);
+	const int32 DY = FMath::Abs(CellA / Grid.Width - CellB / Grid.Width);
+	return FMath::Max(DX, DY) + (RancGrid::Sqrt2 - 1.f) * FMath::Min(DX, DY);
+}
@@ -0,0 +1,191 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "RancLootTableSubsystem.h"
+
+namespace
+{
+	bool IsLootTable(const UDataTable* Table)
+	{
+		return Table && Table->GetRowStruct() && Table->GetRowStruct()->IsChildOf(FRancLootTableRow::StaticStruct());
+	}
+}
+
+void URancLootTableSubsystem::Deinitialize()
+{
+	for (const TPair<TObjectKey<UDataTable>, FDelegateHandle>& Watched : WatchedTables)
+	{
+		if (UDataTable* Table = Watched.Key.ResolveObjectPtr())
+		{
+			Table->OnDataTableChanged().Remove(Watched.Value);
+		}
+	}
+	WatchedTables.Empty();
+	CompiledTables.Empty();
+
+	Super::Deinitialize();
+}
+
+UObject* URancLootTableSubsystem::RollLootTable(UDataTable* Table)
+{
+	const FCompiledLootTable* Compiled = FindOrCompile(Table);
+	if (!Compiled || Compiled->Items.IsEmpty())
+	{
+		return nullptr;
+	}
+	return Compiled->Items[Compiled->Sampler.Sample()];
+}
+
+UObject* URancLootTableSubsystem::RollLootTable(UDataTable* Table, FRancRandom& Random)
+{
+	const FCompiledLootTable* Compiled = FindOrCompile(Table);
+	if (!Compiled || Compiled->Items.IsEmpty())
+	{
+		return nullptr;
+	}
+	return Compiled->Items[Compiled->Sampler.Sample(Random)];
+}
+
+TArray<UObject*> URancLootTableSubsystem::RollLootTableMany(UDataTable* Table, int32 Count)
+{
+	TArray<UObject*> Result;
+	const FCompiledLootTable* Compiled = FindOrCompile(Table);
+	if (!Compiled || Compiled->Items.IsEmpty() || Count <= 0)
+	{
+		return Result;
+	}
+
+	Result.Reserve(Count);
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Result.Add(Compiled->Items[Compiled->Sampler.Sample()]);
+	}
+	return Result;
+}
+
+void URancLootTableSubsystem::PrecompileLootTable(UDataTable* Table)
+{
+	FindOrCompile(Table);
+}
+
+void URancLootTableSubsystem::InvalidateLootTable(UDataTable* Table)
+{
+	HandleDataTableChanged(Table);
+}
+
+const URancLootTableSubsystem::FCompiledLootTable* URancLootTableSubsystem::FindOrCompile(UDataTable* Table)
+{
+	if (!IsLootTable(Table))
+	{
+		if (Table)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RollLootTable: %s does not use FRancLootTableRow rows."), *Table->GetName());
+		}
+		return nullptr;
+	}
+
+	if (const FCompiledLootTable* Compiled = CompiledTables.Find(Table))
+	{
+		return Compiled;
+	}
+
+	FCompiledLootTable Compiled;
+	TArray<double> Weights;
+	TArray<UDataTable*> Stack;
+	Flatten(Table, Stack, Compiled.Dependencies, Compiled.Items, Weights);
+
+	TArray<float> SamplerWeights;
+	SamplerWeights.Reserve(Weights.Num());
+	for (const double Weight : Weights)
+	{
+		SamplerWeights.Add(static_cast<float>(Weight));
+	}
+	Compiled.Sampler.Build(SamplerWeights);
+
+	for (const TObjectKey<UDataTable>& Dependency : Compiled.Dependencies)
+	{
+		WatchTable(Dependency.ResolveObjectPtr());
+	}
+	return &CompiledTables.Add(Table, MoveTemp(Compiled));
+}
+
+double URancLootTableSubsystem::Flatten(UDataTable* Table, TArray<UDataTable*>& Stack, TArray<TObjectKey<UDataTable>>& Dependencies,
+	TArray<UObject*>& OutItems, TArray<double>& OutWeights)
+{
+	if (Stack.Contains(Table))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RollLootTable: %s nests itself, the nested row is skipped."), *Table->GetName());
+		return 0.0;
+	}
+
+	Stack.Push(Table);
+	Dependencies.AddUnique(Table);
+
+	double TotalWeight = 0.0;
+	TArray<UObject*> NestedItems;
+	TArray<double> NestedWeights;
+	for (const TPair<FName, uint8*>& Row : Table->GetRowMap())
+	{
+		const FRancLootTableRow* LootRow = reinterpret_cast<const FRancLootTableRow*>(Row.Value);
+		if (!(LootRow->Weight > 0.f))
+		{
+			continue;
+		}
+
+		if (LootRow->NestedTable)
+		{
+			if (!IsLootTable(LootRow->NestedTable))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("RollLootTable: Row %s of %s nests %s, which does not use FRancLootTableRow rows."),
+					*Row.Key.ToString(), *Table->GetName(), *LootRow->NestedTable->GetName());
+				continue;
+			}
+
+			// The nested rows split this row's weight in proportion to the weight they actually emitted,
+			// so the nested table rolls the same inside this one as on its own
+			NestedItems.Reset();
+			NestedWeights.Reset();
+			const double NestedTotal = Flatten(LootRow->NestedTable, Stack, Dependencies, NestedItems, NestedWeights);
+			if (NestedTotal > 0.0)
+			{
+				const double Scale = LootRow->Weight / NestedTotal;
+				for (int32 i = 0; i < NestedItems.Num(); ++i)
+				{
+					OutItems.Add(NestedItems[i]);
+					OutWeights.Add(NestedWeights[i] * Scale);
+				}
+				TotalWeight += LootRow->Weight;
+			}
+			continue;
+		}
+
+		OutItems.Add(LootRow->Item);
+		OutWeights.Add(LootRow->Weight);
+		TotalWeight += LootRow->Weight;
+	}
+
+	Stack.Pop(EAllowShrinking::No);
+	return TotalWeight;
+}
+
+void URancLootTableSubsystem::WatchTable(UDataTable* Table)
+{
+	if (!Table || WatchedTables.Contains(Table))
+	{
+		return;
+	}
+
+	const FDelegateHandle Handle = Table->OnDataTableChanged().AddUObject(this, &URancLootTableSubsystem::HandleDataTableChanged, TObjectKey<UDataTable>(Table));
+	WatchedTables.Add(Table, Handle);
+}
+
+void URancLootTableSubsystem::HandleDataTableChanged(TObjectKey<UDataTable> Table)
+{
+	// Drop every compiled table that flattened the changed one, they are rebuilt on their next roll
+	for (auto It = CompiledTables.CreateIterator(); It; ++It)
+	{
+		if (It.Value().Dependencies.Contains(Table))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
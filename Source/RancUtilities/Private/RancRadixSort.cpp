@@ -0,0 +1,9 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "RancRadixSort.h"
+
+FRancRadixSortScratch& RancRadixSort::GetThreadScratch()
+{
+	static thread_local FRancRadixSortScratch Scratch;
+	return Scratch;
+}
@@ -0,0 +1,33 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "RancRandom.h"
+#include <atomic>
+
+namespace
+{
+	std::atomic<uint64> ThreadStreamSeed{FPlatformTime::Cycles64()};
+	// Bumped by SetThreadStreamSeed so every thread reinitializes its stream
+	std::atomic<uint32> ThreadStreamGeneration{0};
+	std::atomic<uint32> NextThreadStreamIndex{0};
+}
+
+FRancRandom& RancRandom::GetThreadStream()
+{
+	thread_local FRancRandom Stream;
+	thread_local uint32 StreamGeneration = MAX_uint32;
+	thread_local const uint32 StreamIndex = NextThreadStreamIndex.fetch_add(1, std::memory_order_relaxed);
+
+	const uint32 Generation = ThreadStreamGeneration.load(std::memory_order_acquire);
+	if (StreamGeneration != Generation)
+	{
+		Stream.Initialize(ThreadStreamSeed.load(std::memory_order_relaxed), StreamIndex);
+		StreamGeneration = Generation;
+	}
+	return Stream;
+}
+
+void RancRandom::SetThreadStreamSeed(uint64 Seed)
+{
+	ThreadStreamSeed.store(Seed, std::memory_order_relaxed);
+	ThreadStreamGeneration.fetch_add(1, std::memory_order_release);
+}
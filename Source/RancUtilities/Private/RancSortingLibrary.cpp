@@ -2,16 +2,493 @@
 
 #include "RancSortingLibrary.h"
 
+#include "Algo/AllOf.h"
+#include "Algo/Transform.h"
+#include "Async/Async.h"
 #include "ISortableElement.h"
+#include "RancParallelSort.h"
+#include "RancRadixSort.h"
 
-void URancSortingLibrary::SortSortableArray(TArray<UObject*>& ArrayToSort)
+namespace
 {
-	ArrayToSort.Sort([](const UObject& A, const UObject& B) {
-		if (const ISortableElement* SortableA = Cast<ISortableElement>(&A))
+	bool IsSortableLess(const UObject* A, const UObject* B)
+	{
+		return A && A->Implements<USortableElement>() && ISortableElement::Execute_IsLessThan(A, B);
+	}
+
+	// Indices of the K smallest elements in sorted order, keeping the best K so far in a heap whose top is the worst of them
+	template <typename PredicateType>
+	TArray<int32> SelectSmallestIndices(TConstArrayView<UObject*> Array, int32 K, PredicateType Less)
+	{
+		TArray<int32> Heap;
+		K = FMath::Clamp(K, 0, Array.Num());
+		if (K == 0)
+		{
+			return Heap;
+		}
+
+		Heap.Reserve(K + 1);
+		const auto WorstFirst = [Array, &Less](int32 A, int32 B) { return Less(Array[B], Array[A]); };
+		for (int32 i = 0; i < Array.Num(); ++i)
+		{
+			if (Heap.Num() < K)
+			{
+				Heap.HeapPush(i, WorstFirst);
+			}
+			else if (Less(Array[i], Array[Heap.HeapTop()]))
+			{
+				Heap.HeapPopDiscard(WorstFirst, EAllowShrinking::No);
+				Heap.HeapPush(i, WorstFirst);
+			}
+		}
+
+		Heap.Sort([Array, &Less](int32 A, int32 B) { return Less(Array[A], Array[B]); });
+		return Heap;
+	}
+
+	template <typename PredicateType>
+	void PartialSortObjects(TArray<UObject*>& Array, int32 K, PredicateType Less)
+	{
+		const TArray<int32> Smallest = SelectSmallestIndices(Array, K, Less);
+		if (Smallest.IsEmpty())
+		{
+			return;
+		}
+
+		TBitArray<> Selected(false, Array.Num());
+		TArray<UObject*> Result;
+		Result.Reserve(Array.Num());
+		for (const int32 Index : Smallest)
+		{
+			Selected[Index] = true;
+			Result.Add(Array[Index]);
+		}
+		for (int32 i = 0; i < Array.Num(); ++i)
+		{
+			if (!Selected[i])
+			{
+				Result.Add(Array[i]);
+			}
+		}
+		Array = MoveTemp(Result);
+	}
+
+	// Quickselect with a median of three pivot
+	template <typename PredicateType>
+	void NthElementObjects(TArray<UObject*>& Array, int32 N, PredicateType Less)
+	{
+		if (!Array.IsValidIndex(N))
+		{
+			return;
+		}
+
+		int32 Low = 0;
+		int32 High = Array.Num() - 1;
+		while (Low < High)
+		{
+			const int32 Mid = Low + (High - Low) / 2;
+			if (Less(Array[Mid], Array[Low]))
+			{
+				Swap(Array[Mid], Array[Low]);
+			}
+			if (Less(Array[High], Array[Low]))
+			{
+				Swap(Array[High], Array[Low]);
+			}
+			if (Less(Array[High], Array[Mid]))
+			{
+				Swap(Array[High], Array[Mid]);
+			}
+
+			// The scans are bounded as well, an inconsistent Blueprint comparison must not run them off the range
+			const UObject* Pivot = Array[Mid];
+			int32 Left = Low;
+			int32 Right = High;
+			while (Left <= Right)
+			{
+				while (Left < High && Less(Array[Left], Pivot))
+				{
+					++Left;
+				}
+				while (Right > Low && Less(Pivot, Array[Right]))
+				{
+					--Right;
+				}
+				if (Left <= Right)
+				{
+					Swap(Array[Left++], Array[Right--]);
+				}
+			}
+
+			// Everything in (Right, Left) equals the pivot
+			if (N <= Right)
+			{
+				High = Right;
+			}
+			else if (N >= Left)
+			{
+				Low = Left;
+			}
+			else
+			{
+				return;
+			}
+		}
+	}
+
+	TArray<UObject*> GatherIndices(TConstArrayView<UObject*> Array, TConstArrayView<int32> Indices)
+	{
+		TArray<UObject*> Result;
+		Result.Reserve(Indices.Num());
+		for (const int32 Index : Indices)
+		{
+			Result.Add(Array[Index]);
+		}
+		return Result;
+	}
+
+	// Positions index the keyed elements, equal keys keep their order so the result doesn't depend on the sort algorithm
+	TArray<int32> SortProviderKeyPositions(TConstArrayView<FRancSortKey> Keys)
+	{
+		TArray<int32> Positions;
+
+		// Numeric keys of a single type can take the stable radix sort, which keeps the same tie order
+		const ERancSortKeyType FirstType = Keys.IsEmpty() ? ERancSortKeyType::Name : Keys[0].Type;
+		if (FirstType != ERancSortKeyType::Name && Algo::AllOf(Keys, [FirstType](const FRancSortKey& Key) { return Key.Type == FirstType; }))
+		{
+			if (FirstType == ERancSortKeyType::Float)
+			{
+				TArray<float> FloatKeys;
+				Algo::Transform(Keys, FloatKeys, [](const FRancSortKey& Key) { return Key.FloatKey; });
+				RancRadixSort::SortIndices<float>(FloatKeys, Positions, RancRadixSort::GetThreadScratch());
+			}
+			else
+			{
+				TArray<int64> IntKeys;
+				Algo::Transform(Keys, IntKeys, [](const FRancSortKey& Key) { return Key.IntKey; });
+				RancRadixSort::SortIndices<int64>(IntKeys, Positions, RancRadixSort::GetThreadScratch());
+			}
+			return Positions;
+		}
+
+		Positions.Reserve(Keys.Num());
+		for (int32 i = 0; i < Keys.Num(); ++i)
+		{
+			Positions.Add(i);
+		}
+
+		RancParallelSort::Sort(Positions, [Keys](int32 A, int32 B) {
+			if (Keys[A] < Keys[B])
+			{
+				return true;
+			}
+			return !(Keys[B] < Keys[A]) && A < B;
+		});
+		return Positions;
+	}
+
+	// Reads every key once, objects that don't provide one go to OutUnkeyed
+	void ExtractProviderKeys(const TArray<UObject*>& ArrayToSort, TArray<UObject*>& OutKeyed, TArray<FRancSortKey>& OutKeys, TArray<UObject*>& OutUnkeyed)
+	{
+		OutKeyed.Reserve(ArrayToSort.Num());
+		OutKeys.Reserve(ArrayToSort.Num());
+		for (UObject* Object : ArrayToSort)
+		{
+			if (Object && Object->Implements<USortKeyProvider>())
+			{
+				OutKeyed.Add(Object);
+				OutKeys.Add(ISortKeyProvider::Execute_GetSortKey(Object));
+			}
+			else
+			{
+				OutUnkeyed.Add(Object);
+			}
+		}
+	}
+
+	// The keyed objects in sorted order followed by the unkeyed ones
+	TArray<UObject*> GatherSorted(TConstArrayView<UObject*> Keyed, TConstArrayView<int32> Positions, TConstArrayView<UObject*> Unkeyed)
+	{
+		TArray<UObject*> SortedArray;
+		SortedArray.Reserve(Positions.Num() + Unkeyed.Num());
+		for (const int32 Position : Positions)
+		{
+			SortedArray.Add(Keyed[Position]);
+		}
+		SortedArray.Append(Unkeyed.GetData(), Unkeyed.Num());
+		return SortedArray;
+	}
+
+	// Sorts natively on the extracted keys and permutes the array once
+	TArray<UObject*> SortByExtractedKeys(const TArray<UObject*>& ArrayToSort)
+	{
+		TArray<UObject*> Keyed;
+		TArray<FRancSortKey> Keys;
+		TArray<UObject*> Unkeyed;
+		ExtractProviderKeys(ArrayToSort, Keyed, Keys, Unkeyed);
+		return GatherSorted(Keyed, SortProviderKeyPositions(Keys), Unkeyed);
+	}
+}
+
+namespace
+{
+	enum class EPropertyKeyKind : uint8
+	{
+		None,
+		Float,
+		Int,
+		UInt,
+		Name,
+		String
+	};
+
+	EPropertyKeyKind GetKeyKind(const FProperty* Property)
+	{
+		if (!Property)
+		{
+			return EPropertyKeyKind::None;
+		}
+		if (Property->IsA<FEnumProperty>() || Property->IsA<FBoolProperty>())
 		{
-			return SortableA->IsLessThan(&B);
+			return EPropertyKeyKind::Int;
 		}
-		return false;
+		if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+		{
+			if (NumericProperty->IsFloatingPoint())
+			{
+				return EPropertyKeyKind::Float;
+			}
+			return Property->IsA<FUInt64Property>() ? EPropertyKeyKind::UInt : EPropertyKeyKind::Int;
+		}
+		if (Property->IsA<FNameProperty>())
+		{
+			return EPropertyKeyKind::Name;
+		}
+		if (Property->IsA<FStrProperty>())
+		{
+			return EPropertyKeyKind::String;
+		}
+		return EPropertyKeyKind::None;
+	}
+
+	// Blueprint structs mangle their property names, so fall back to the name the user typed
+	const FProperty* FindSortProperty(const UStruct* Struct, FName PropertyName)
+	{
+		if (const FProperty* Property = FindFProperty<FProperty>(Struct, PropertyName))
+		{
+			return Property;
+		}
+
+		const FString AuthoredName = PropertyName.ToString();
+		for (TFieldIterator<FProperty> It(Struct); It; ++It)
+		{
+			if (It->GetAuthoredName() == AuthoredName)
+			{
+				return *It;
+			}
+		}
+		return nullptr;
+	}
+
+	// The values of one sort property, entry p belongs to the p-th keyed element
+	struct FKeyColumn
+	{
+		EPropertyKeyKind Kind = EPropertyKeyKind::None;
+		bool bDescending = false;
+		TArray<double> Floats;
+		TArray<int64> Ints;
+		TArray<uint64> UInts;
+		TArray<FName> Names;
+		// Strings are compared in place, the elements don't move until the sort is done
+		TArray<const FString*> Strings;
+		// Set by OwnStrings for sorts that outlive the elements' current state
+		TArray<FString> OwnedStrings;
+
+		// Copies the strings so the sort no longer reads the elements, e.g. before sorting on another thread
+		void OwnStrings()
+		{
+			OwnedStrings.Reset(Strings.Num());
+			for (int32 i = 0; i < Strings.Num(); ++i)
+			{
+				OwnedStrings.Add(*Strings[i]);
+			}
+			for (int32 i = 0; i < Strings.Num(); ++i)
+			{
+				Strings[i] = &OwnedStrings[i];
+			}
+		}
+
+		void Add(const FProperty* Property, const void* Container)
+		{
+			const void* Value = Property->ContainerPtrToValuePtr<void>(Container);
+			switch (Kind)
+			{
+			case EPropertyKeyKind::Float:
+				Floats.Add(CastFieldChecked<FNumericProperty>(Property)->GetFloatingPointPropertyValue(Value));
+				break;
+			case EPropertyKeyKind::Int:
+				if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+				{
+					Ints.Add(EnumProperty->GetUnderlyingProperty()->GetSignedIntPropertyValue(Value));
+				}
+				else if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+				{
+					Ints.Add(BoolProperty->GetPropertyValue(Value) ? 1 : 0);
+				}
+				else
+				{
+					Ints.Add(CastFieldChecked<FNumericProperty>(Property)->GetSignedIntPropertyValue(Value));
+				}
+				break;
+			case EPropertyKeyKind::UInt:
+				UInts.Add(CastFieldChecked<FNumericProperty>(Property)->GetUnsignedIntPropertyValue(Value));
+				break;
+			case EPropertyKeyKind::Name:
+				Names.Add(*static_cast<const FName*>(Value));
+				break;
+			case EPropertyKeyKind::String:
+				Strings.Add(static_cast<const FString*>(Value));
+				break;
+			default:
+				break;
+			}
+		}
+
+		template <typename T>
+		static int32 CompareValues(const T& A, const T& B)
+		{
+			return A < B ? -1 : (B < A ? 1 : 0);
+		}
+
+		int32 Compare(int32 A, int32 B) const
+		{
+			int32 Result = 0;
+			switch (Kind)
+			{
+			case EPropertyKeyKind::Float: Result = CompareValues(Floats[A], Floats[B]); break;
+			case EPropertyKeyKind::Int: Result = CompareValues(Ints[A], Ints[B]); break;
+			case EPropertyKeyKind::UInt: Result = CompareValues(UInts[A], UInts[B]); break;
+			case EPropertyKeyKind::Name: Result = Names[A].Compare(Names[B]); break;
+			case EPropertyKeyKind::String: Result = Strings[A]->Compare(*Strings[B], ESearchCase::IgnoreCase); break;
+			default: break;
+			}
+			return bDescending ? -Result : Result;
+		}
+	};
+
+	// Orders the keyed elements by the columns, equal elements keep their order.
+	// Returns the position of the element that goes first, then the second and so on.
+	TArray<int32> SortKeyPositions(int32 NumKeyed, TConstArrayView<FKeyColumn> Columns)
+	{
+		TArray<int32> Positions;
+
+		// A single numeric key can take the stable radix sort, which keeps the same tie order
+		if (Columns.Num() == 1)
+		{
+			const FKeyColumn& Column = Columns[0];
+			FRancRadixSortScratch& Scratch = RancRadixSort::GetThreadScratch();
+			switch (Column.Kind)
+			{
+			case EPropertyKeyKind::Float: RancRadixSort::SortIndices<double>(Column.Floats, Positions, Scratch, Column.bDescending); return Positions;
+			case EPropertyKeyKind::Int: RancRadixSort::SortIndices<int64>(Column.Ints, Positions, Scratch, Column.bDescending); return Positions;
+			case EPropertyKeyKind::UInt: RancRadixSort::SortIndices<uint64>(Column.UInts, Positions, Scratch, Column.bDescending); return Positions;
+			default: break;
+			}
+		}
+
+		Positions.Reserve(NumKeyed);
+		for (int32 i = 0; i < NumKeyed; ++i)
+		{
+			Positions.Add(i);
+		}
+
+		RancParallelSort::Sort(Positions, [Columns](int32 A, int32 B) {
+			for (const FKeyColumn& Column : Columns)
+			{
+				if (const int32 Result = Column.Compare(A, B))
+				{
+					return Result < 0;
+				}
+			}
+			return A < B;
+		});
+		return Positions;
+	}
+
+	// Reads the sort properties of every object into Columns, objects lacking one of them go to OutUnkeyed.
+	// Returns false if no object has them.
+	bool ExtractPropertyKeys(const TArray<UObject*>& ArrayToSort, TConstArrayView<FRancSortProperty> SortProperties,
+		TArray<UObject*>& OutKeyed, TArray<FKeyColumn>& OutColumns, TArray<UObject*>& OutUnkeyed)
+	{
+		OutColumns.SetNum(SortProperties.Num());
+		for (int32 k = 0; k < SortProperties.Num(); ++k)
+		{
+			OutColumns[k].bDescending = SortProperties[k].bDescending;
+		}
+
+		// Resolved once per class, an entry is empty if the class lacks one of the properties
+		TMap<const UClass*, TArray<const FProperty*, TInlineAllocator<4>>> ClassProperties;
+		OutKeyed.Reserve(ArrayToSort.Num());
+
+		for (UObject* Object : ArrayToSort)
+		{
+			const TArray<const FProperty*, TInlineAllocator<4>>* Properties = nullptr;
+			if (Object)
+			{
+				const UClass* Class = Object->GetClass();
+				Properties = ClassProperties.Find(Class);
+				if (!Properties)
+				{
+					TArray<const FProperty*, TInlineAllocator<4>> Resolved;
+					for (int32 k = 0; k < SortProperties.Num(); ++k)
+					{
+						const FProperty* Property = FindSortProperty(Class, SortProperties[k].PropertyName);
+						const EPropertyKeyKind Kind = GetKeyKind(Property);
+						// A class whose property has a different type than the first accepted class can't be compared with it
+						if (Kind == EPropertyKeyKind::None || (OutColumns[k].Kind != EPropertyKeyKind::None && Kind != OutColumns[k].Kind))
+						{
+							Resolved.Reset();
+							break;
+						}
+						Resolved.Add(Property);
+					}
+
+					// Only a class that has every key fixes the column types, a rejected class must not lock them
+					for (int32 k = 0; k < Resolved.Num(); ++k)
+					{
+						OutColumns[k].Kind = GetKeyKind(Resolved[k]);
+					}
+					Properties = &ClassProperties.Add(Class, MoveTemp(Resolved));
+				}
+			}
+
+			if (!Properties || Properties->IsEmpty())
+			{
+				OutUnkeyed.Add(Object);
+				continue;
+			}
+
+			OutKeyed.Add(Object);
+			for (int32 k = 0; k < OutColumns.Num(); ++k)
+			{
+				OutColumns[k].Add((*Properties)[k], Object);
+			}
+		}
+
+		if (OutKeyed.IsEmpty())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SortByProperties: No object has sortable properties named %s."), *SortProperties[0].PropertyName.ToString());
+			return false;
+		}
+		return true;
+	}
+}
+
+void URancSortingLibrary::SortSortableArray(TArray<UObject*>& ArrayToSort)
+{
+	ArrayToSort.Sort([](const UObject& A, const UObject& B) {
+		// Through Execute_IsLessThan, calling the interface event directly asserts and skips Blueprint implementations
+		return IsSortableLess(&A, &B);
 	});
 }
 
@@ -19,11 +496,7 @@ TArray<UObject*> URancSortingLibrary::GetSortedArrayCopy(const TArray<UObject*>&
 {
 	TArray<UObject*> SortedArray = ArrayToSort;
 	SortedArray.Sort([](const UObject& A, const UObject& B) {
-		if (const ISortableElement* SortableA = Cast<ISortableElement>(&A))
-		{
-			return SortableA->IsLessThan(&B);
-		}
-		return false;
+		return IsSortableLess(&A, &B);
 	});
 	return SortedArray;
 }
@@ -36,4 +509,280 @@ TArray<UObject*> URancSortingLibrary::GetSortedArrayCopyWithDelegate(const TArra
         return ComparisonFunction.Execute(&A, &B);
     });
     return SortedArray;
+}
+
+void URancSortingLibrary::PartialSortSortableArray(TArray<UObject*>& ArrayToSort, int32 K)
+{
+	PartialSortObjects(ArrayToSort, K, IsSortableLess);
+}
+
+void URancSortingLibrary::PartialSortArrayWithDelegate(TArray<UObject*>& ArrayToSort, int32 K, const FCompareDelegate& ComparisonFunction)
+{
+	PartialSortObjects(ArrayToSort, K, [&ComparisonFunction](const UObject* A, const UObject* B) {
+		return ComparisonFunction.Execute(A, B);
+	});
+}
+
+void URancSortingLibrary::NthElementSortableArray(TArray<UObject*>& ArrayToSort, int32 N)
+{
+	NthElementObjects(ArrayToSort, N, IsSortableLess);
+}
+
+void URancSortingLibrary::NthElementArrayWithDelegate(TArray<UObject*>& ArrayToSort, int32 N, const FCompareDelegate& ComparisonFunction)
+{
+	NthElementObjects(ArrayToSort, N, [&ComparisonFunction](const UObject* A, const UObject* B) {
+		return ComparisonFunction.Execute(A, B);
+	});
+}
+
+TArray<UObject*> URancSortingLibrary::SelectTopK(const TArray<UObject*>& Array, int32 K)
+{
+	return GatherIndices(Array, SelectSmallestIndices(Array, K, IsSortableLess));
+}
+
+TArray<UObject*> URancSortingLibrary::SelectTopKWithDelegate(const TArray<UObject*>& Array, int32 K, const FCompareDelegate& ComparisonFunction)
+{
+	return GatherIndices(Array, SelectSmallestIndices(Array, K, [&ComparisonFunction](const UObject* A, const UObject* B) {
+		return ComparisonFunction.Execute(A, B);
+	}));
+}
+
+void URancSortingLibrary::SortByKey(TArray<UObject*>& ArrayToSort)
+{
+	ArrayToSort = SortByExtractedKeys(ArrayToSort);
+}
+
+TArray<UObject*> URancSortingLibrary::GetSortedArrayCopyByKey(const TArray<UObject*>& ArrayToSort)
+{
+	return SortByExtractedKeys(ArrayToSort);
+}
+
+FRancSortKey URancSortingLibrary::MakeFloatSortKey(float Key)
+{
+	FRancSortKey SortKey;
+	SortKey.Type = ERancSortKeyType::Float;
+	SortKey.FloatKey = Key;
+	return SortKey;
+}
+
+FRancSortKey URancSortingLibrary::MakeIntSortKey(int64 Key)
+{
+	FRancSortKey SortKey;
+	SortKey.Type = ERancSortKeyType::Int;
+	SortKey.IntKey = Key;
+	return SortKey;
+}
+
+FRancSortKey URancSortingLibrary::MakeNameSortKey(FName Key)
+{
+	FRancSortKey SortKey;
+	SortKey.Type = ERancSortKeyType::Name;
+	SortKey.NameKey = Key;
+	return SortKey;
+}
+
+void URancSortingLibrary::SortByProperty(TArray<UObject*>& ArrayToSort, FName PropertyName, bool bDescending)
+{
+	FRancSortProperty SortProperty;
+	SortProperty.PropertyName = PropertyName;
+	SortProperty.bDescending = bDescending;
+	SortByProperties(ArrayToSort, {SortProperty});
+}
+
+void URancSortingLibrary::SortByProperties(TArray<UObject*>& ArrayToSort, const TArray<FRancSortProperty>& SortProperties)
+{
+	if (SortProperties.IsEmpty() || ArrayToSort.Num() < 2)
+	{
+		return;
+	}
+
+	TArray<UObject*> Keyed;
+	TArray<FKeyColumn> Columns;
+	TArray<UObject*> Unkeyed;
+	if (ExtractPropertyKeys(ArrayToSort, SortProperties, Keyed, Columns, Unkeyed))
+	{
+		ArrayToSort = GatherSorted(Keyed, SortKeyPositions(Keyed.Num(), Columns), Unkeyed);
+	}
+}
+
+void URancSortingLibrary::RadixSortFloatPairs(TArray<float>& Keys, TArray<int32>& Values, bool bDescending)
+{
+	if (Keys.Num() != Values.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RadixSortFloatPairs: Keys and Values should have the same length (%d vs %d)."), Keys.Num(), Values.Num());
+		return;
+	}
+	RancRadixSort::SortPairs(MakeArrayView(Keys), MakeArrayView(Values), RancRadixSort::GetThreadScratch(), bDescending);
+}
+
+void URancSortingLibrary::RadixSortIntPairs(TArray<int32>& Keys, TArray<int32>& Values, bool bDescending)
+{
+	if (Keys.Num() != Values.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RadixSortIntPairs: Keys and Values should have the same length (%d vs %d)."), Keys.Num(), Values.Num());
+		return;
+	}
+	RancRadixSort::SortPairs(MakeArrayView(Keys), MakeArrayView(Values), RancRadixSort::GetThreadScratch(), bDescending);
+}
+
+void URancSortingLibrary::RadixSortInt64Pairs(TArray<int64>& Keys, TArray<int32>& Values, bool bDescending)
+{
+	if (Keys.Num() != Values.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RadixSortInt64Pairs: Keys and Values should have the same length (%d vs %d)."), Keys.Num(), Values.Num());
+		return;
+	}
+	RancRadixSort::SortPairs(MakeArrayView(Keys), MakeArrayView(Values), RancRadixSort::GetThreadScratch(), bDescending);
+}
+
+void URancSortingLibrary::RadixSortObjectsByFloat(TArray<float>& Keys, TArray<UObject*>& Objects, bool bDescending)
+{
+	if (Keys.Num() != Objects.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RadixSortObjectsByFloat: Keys and Objects should have the same length (%d vs %d)."), Keys.Num(), Objects.Num());
+		return;
+	}
+	RancRadixSort::SortPairs(MakeArrayView(Keys), MakeArrayView(Objects), RancRadixSort::GetThreadScratch(), bDescending);
+}
+
+void URancSortingLibrary::SortStructArrayByProperty(TArray<int32>& TargetArray, FName PropertyName, bool bDescending)
+{
+	// Never called, the custom thunk runs GenericSortStructArrayByProperties instead
+	check(0);
+}
+
+void URancSortingLibrary::SortStructArrayByProperties(TArray<int32>& TargetArray, const TArray<FRancSortProperty>& SortProperties)
+{
+	// Never called, the custom thunk runs GenericSortStructArrayByProperties instead
+	check(0);
+}
+
+void URancSortingLibrary::GenericSortStructArrayByProperties(void* TargetArray, const FArrayProperty* ArrayProperty, TConstArrayView<FRancSortProperty> SortProperties)
+{
+	const FStructProperty* InnerProperty = CastField<FStructProperty>(ArrayProperty->Inner);
+	if (!InnerProperty)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SortStructArrayByProperties: %s is not an array of structs."), *ArrayProperty->GetName());
+		return;
+	}
+
+	FScriptArrayHelper ArrayHelper(ArrayProperty, TargetArray);
+	if (SortProperties.IsEmpty() || ArrayHelper.Num() < 2)
+	{
+		return;
+	}
+
+	TArray<FKeyColumn> Columns;
+	TArray<const FProperty*, TInlineAllocator<4>> Properties;
+	Columns.SetNum(SortProperties.Num());
+	for (int32 k = 0; k < SortProperties.Num(); ++k)
+	{
+		const FProperty* Property = FindSortProperty(InnerProperty->Struct, SortProperties[k].PropertyName);
+		Columns[k].Kind = GetKeyKind(Property);
+		Columns[k].bDescending = SortProperties[k].bDescending;
+		if (Columns[k].Kind == EPropertyKeyKind::None)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SortStructArrayByProperties: %s has no sortable property named %s."),
+				*InnerProperty->Struct->GetName(), *SortProperties[k].PropertyName.ToString());
+			return;
+		}
+		Properties.Add(Property);
+	}
+
+	const int32 Num = ArrayHelper.Num();
+	for (int32 i = 0; i < Num; ++i)
+	{
+		for (int32 k = 0; k < Columns.Num(); ++k)
+		{
+			Columns[k].Add(Properties[k], ArrayHelper.GetRawPtr(i));
+		}
+	}
+
+	// Element i moves to where it belongs by following permutation cycles, one swap per misplaced element
+	const TArray<int32> Positions = SortKeyPositions(Num, Columns);
+	TBitArray<> Placed(false, Num);
+	for (int32 Start = 0; Start < Num; ++Start)
+	{
+		int32 Current = Start;
+		while (!Placed[Current])
+		{
+			Placed[Current] = true;
+			const int32 Source = Positions[Current];
+			if (Source == Start)
+			{
+				break;
+			}
+			ArrayHelper.SwapValues(Current, Source);
+			Current = Source;
+		}
+	}
+}
+
+URancAsyncSortAction* URancAsyncSortAction::SortByPropertiesAsync(UObject* WorldContextObject, const TArray<UObject*>& ArrayToSort, const TArray<FRancSortProperty>& SortProperties)
+{
+	URancAsyncSortAction* Action = NewObject<URancAsyncSortAction>();
+	Action->Source = ArrayToSort;
+	Action->SortProperties = SortProperties;
+	Action->RegisterWithGameInstance(WorldContextObject);
+	return Action;
+}
+
+URancAsyncSortAction* URancAsyncSortAction::SortByKeyAsync(UObject* WorldContextObject, const TArray<UObject*>& ArrayToSort)
+{
+	URancAsyncSortAction* Action = NewObject<URancAsyncSortAction>();
+	Action->Source = ArrayToSort;
+	Action->bSortByKey = true;
+	Action->RegisterWithGameInstance(WorldContextObject);
+	return Action;
+}
+
+void URancAsyncSortAction::Activate()
+{
+	// The worker only sees copies of the keys, never the objects
+	TUniqueFunction<TArray<int32>()> SortKeys;
+	if (bSortByKey)
+	{
+		TArray<FRancSortKey> Keys;
+		ExtractProviderKeys(Source, Keyed, Keys, Unkeyed);
+		SortKeys = [Keys = MoveTemp(Keys)]() { return SortProviderKeyPositions(Keys); };
+	}
+	else
+	{
+		TArray<FKeyColumn> Columns;
+		if (SortProperties.IsEmpty() || !ExtractPropertyKeys(Source, SortProperties, Keyed, Columns, Unkeyed))
+		{
+			Completed.Broadcast(Source);
+			SetReadyToDestroy();
+			return;
+		}
+
+		for (FKeyColumn& Column : Columns)
+		{
+			Column.OwnStrings();
+		}
+		const int32 NumKeyed = Keyed.Num();
+		SortKeys = [Columns = MoveTemp(Columns), NumKeyed]() { return SortKeyPositions(NumKeyed, Columns); };
+	}
+	Source.Empty();
+
+	TWeakObjectPtr<URancAsyncSortAction> WeakThis(this);
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, SortKeys = MoveTemp(SortKeys)]()
+	{
+		TArray<int32> Positions = SortKeys();
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Positions = MoveTemp(Positions)]()
+		{
+			if (URancAsyncSortAction* Action = WeakThis.Get())
+			{
+				Action->Finish(Positions);
+			}
+		});
+	});
+}
+
+void URancAsyncSortAction::Finish(TConstArrayView<int32> Positions)
+{
+	Completed.Broadcast(GatherSorted(Keyed, Positions, Unkeyed));
+	Keyed.Empty();
+	Unkeyed.Empty();
+	SetReadyToDestroy();
 }
\ No newline at end of file
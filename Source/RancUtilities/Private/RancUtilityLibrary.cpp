@@ -18,6 +18,50 @@
 #include "Engine/GameViewportClient.h"
 #include "GameFramework/Pawn.h"
 #include "Components/StaticMeshComponent.h"
+#include "RancRandom.h"
+
+namespace
+{
+	// Shared by the global, FRandomStream and FRancRandom versions of the random utilities
+	template <typename RandomType>
+	void PickRandomBranch(RandomType& Random, float Chance1, float Chance2, float Chance3, ERandomBranchState& Branches)
+	{
+		const float TotalChance = Chance1 + Chance2 + Chance3;
+		if (TotalChance <= 0.f)
+		{
+			return;
+		}
+
+		const float RandomValue = Random.FRandRange(0.f, TotalChance);
+
+		if (RandomValue < Chance1)
+		{
+			Branches = ERandomBranchState::Branch1;
+		}
+		else if (RandomValue < Chance1 + Chance2)
+		{
+			Branches = ERandomBranchState::Branch2;
+		}
+		else
+		{
+			Branches = ERandomBranchState::Branch3;
+		}
+	}
+
+	template <typename RandomType>
+	FVector MakeRandomWorldPlaneUnitVector(RandomType& Random)
+	{
+		// Generate a random angle in radians
+		const float RandAngle = Random.FRandRange(0.0f, 2.0f * PI);
+
+		// Calculate the x and y components using cosine and sine
+		float X = FMath::Cos(RandAngle);
+		float Y = FMath::Sin(RandAngle);
+
+		// Return the unit vector
+		return FVector(X, Y, 0.0f);
+	}
+}
 
 void URancUtilityLibrary::ShouldNotHappen(FString Message)
 {
@@ -112,26 +156,19 @@ void URancUtilityLibrary::ThrottledAction(float ThrottlePeriod, EThrottleActionS
 
 void URancUtilityLibrary::RandomBranch(float Chance1, float Chance2, float Chance3, ERandomBranchState& Branches)
 {
-	const float TotalChance = Chance1 + Chance2 + Chance3;
-	if (TotalChance <= 0.f)
-	{
-		return;
-	}
+	FRancGlobalRandom Random;
+	PickRandomBranch(Random, Chance1, Chance2, Chance3, Branches);
+}
 
-	const float RandomValue = FMath::FRandRange(0.f, TotalChance);
+void URancUtilityLibrary::RandomBranchFromStream(const FRandomStream& Stream, float Chance1, float Chance2, float Chance3,
+                                                 ERandomBranchState& Branches)
+{
+	PickRandomBranch(Stream, Chance1, Chance2, Chance3, Branches);
+}
 
-	if (RandomValue < Chance1)
-	{
-		Branches = ERandomBranchState::Branch1;
-	}
-	else if (RandomValue < Chance1 + Chance2)
-	{
-		Branches = ERandomBranchState::Branch2;
-	}
-	else
-	{
-		Branches = ERandomBranchState::Branch3;
-	}
+void URancUtilityLibrary::RandomBranch(FRancRandom& Random, float Chance1, float Chance2, float Chance3, ERandomBranchState& Branches)
+{
+	PickRandomBranch(Random, Chance1, Chance2, Chance3, Branches);
 }
 
 FVector URancUtilityLibrary::GetLocationInFrontOfActor(AActor* Actor, float Distance)
@@ -223,15 +260,18 @@ FVector URancUtilityLibrary::AddScaledVector(FVector VectorA, FVector VectorB, f
 
 FVector URancUtilityLibrary::GetRandomWorldPlaneUnitVector()
 {
-	// Generate a random angle in radians
-	const float RandAngle = FMath::RandRange(0.0f, 2.0f * PI);
+	FRancGlobalRandom Random;
+	return MakeRandomWorldPlaneUnitVector(Random);
+}
 
-	// Calculate the x and y components using cosine and sine
-	float X = FMath::Cos(RandAngle);
-	float Y = FMath::Sin(RandAngle);
+FVector URancUtilityLibrary::GetRandomWorldPlaneUnitVectorFromStream(const FRandomStream& Stream)
+{
+	return MakeRandomWorldPlaneUnitVector(Stream);
+}
 
-	// Return the unit vector
-	return FVector(X, Y, 0.0f);
+FVector URancUtilityLibrary::GetRandomWorldPlaneUnitVector(FRancRandom& Random)
+{
+	return MakeRandomWorldPlaneUnitVector(Random);
 }
 
 FVector URancUtilityLibrary::GetIntersectionPointWithPlane(const FVector& StartPoint, const FVector& EndPoint, float PlaneZ)
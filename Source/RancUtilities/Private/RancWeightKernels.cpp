@@ -0,0 +1,58 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "RancWeightKernels.h"
+
+float RancWeightKernels::PrefixSum(TConstArrayView<float> Weights, TArrayView<float> OutPrefixSums)
+{
+	check(Weights.Num() == OutPrefixSums.Num());
+	const int32 NumWeights = Weights.Num();
+	const float* Source = Weights.GetData();
+	float* Dest = OutPrefixSums.GetData();
+
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	// Lane masks for shifting a register up by one and by two lanes after a broadcast swizzle
+	const VectorRegister4Float ShiftOneMask = MakeVectorRegisterFloat(0.f, 1.f, 1.f, 1.f);
+	const VectorRegister4Float ShiftTwoMask = MakeVectorRegisterFloat(0.f, 0.f, 1.f, 1.f);
+	VectorRegister4Float Carry = Zero;
+
+	int32 i = 0;
+	for (; i + 4 <= NumWeights; i += 4)
+	{
+		// [a, b, c, d] -> [a, a+b, b+c, c+d] -> [a, a+b, a+b+c, a+b+c+d], then add the total of the previous blocks
+		VectorRegister4Float Sums = VectorMax(VectorLoad(Source + i), Zero);
+		Sums = VectorMultiplyAdd(VectorSwizzle(Sums, 0, 0, 1, 2), ShiftOneMask, Sums);
+		Sums = VectorMultiplyAdd(VectorSwizzle(Sums, 0, 0, 0, 1), ShiftTwoMask, Sums);
+		Sums = VectorAdd(Sums, Carry);
+		VectorStore(Sums, Dest + i);
+		Carry = VectorReplicate(Sums, 3);
+	}
+
+	float Running = i > 0 ? Dest[i - 1] : 0.f;
+	for (; i < NumWeights; ++i)
+	{
+		// Written so NaN counts as 0 as well
+		Running += Source[i] > 0.f ? Source[i] : 0.f;
+		Dest[i] = Running;
+	}
+	return Running;
+}
+
+int32 RancWeightKernels::UpperBound(TConstArrayView<float> PrefixSums, float Value)
+{
+	int32 Count = PrefixSums.Num();
+	if (Count == 0)
+	{
+		return 0;
+	}
+
+	const float* Data = PrefixSums.GetData();
+	int32 Base = 0;
+	while (Count > 1)
+	{
+		const int32 Half = Count / 2;
+		// Compiles to a conditional move
+		Base = Data[Base + Half] <= Value ? Base + Half : Base;
+		Count -= Half;
+	}
+	return Base + (Data[Base] <= Value ? 1 : 0);
+}
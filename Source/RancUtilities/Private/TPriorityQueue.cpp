@@ -14,76 +14,395 @@ bool FPriorityQueueNode::operator<(const FPriorityQueueNode& Other) const
 
 UPriorityQueue::UPriorityQueue()
 {
-	Array.Heapify();
 }
 
 void UPriorityQueue::SetInitialCapacity(int InitialCapacity)
 {
-	ContainsSet.Reserve(InitialCapacity);
-	Array.Reserve(InitialCapacity);
+	HandleMap.Reserve(InitialCapacity);
+	if (Mode == EPriorityQueueMode::Bounded)
+	{
+		BoundedQueue.Reserve(MaxSize > 0 ? FMath::Min(InitialCapacity, MaxSize) : InitialCapacity);
+	}
+	else if (UseRadixQueue())
+	{
+		RadixQueue.Reserve(InitialCapacity);
+	}
+	else
+	{
+		Queue.Reserve(InitialCapacity);
+	}
+}
+
+void UPriorityQueue::SetMode(EPriorityQueueMode NewMode)
+{
+	if (NewMode == Mode)
+	{
+		return;
+	}
+
+	if (NewMode == EPriorityQueueMode::Bounded)
+	{
+		if (UseRadixQueue())
+		{
+			FallBackToBinaryHeap();
+		}
+
+		// The first MaxSize pops are the cheapest elements, the rest is dropped
+		int DataInteger;
+		float Cost;
+		while ((MaxSize <= 0 || BoundedQueue.Num() < MaxSize) && Queue.TryPop(DataInteger, Cost))
+		{
+			HandleMap[DataInteger] = BoundedQueue.Push(DataInteger, Cost);
+		}
+		TArray<int> Dropped;
+		Queue.PopMany(Queue.Num(), Dropped);
+		for (const int DroppedInteger : Dropped)
+		{
+			HandleMap.Remove(DroppedInteger);
+		}
+
+		Mode = NewMode;
+		bMonotoneFallback = false;
+		return;
+	}
+
+	if (Mode == EPriorityQueueMode::Bounded)
+	{
+		Queue.Reserve(BoundedQueue.Num());
+		BoundedQueue.DrainUnordered([this](int DataInteger, float Cost)
+		{
+			HandleMap[DataInteger] = Queue.EmplaceUnordered(Cost, DataInteger);
+		});
+		Queue.Heapify();
+	}
+	else if (NewMode == EPriorityQueueMode::BinaryHeap && UseRadixQueue())
+	{
+		FallBackToBinaryHeap();
+	}
+
+	// Switching to Monotone keeps using the binary heap until it has drained
+	Mode = NewMode;
+	bMonotoneFallback = Mode == EPriorityQueueMode::Monotone && !Queue.IsEmpty();
+}
+
+void UPriorityQueue::SetMaxSize(int32 NewMaxSize)
+{
+	MaxSize = NewMaxSize;
+	if (MaxSize > 0)
+	{
+		TrimBoundedQueue(MaxSize);
+	}
 }
 
 void UPriorityQueue::Clear()
 {
-	Array.Empty();
-	ContainsSet.Empty();
+	Queue.Empty();
+	RadixQueue.Empty();
+	BoundedQueue.Empty();
+	HandleMap.Empty();
+	bMonotoneFallback = false;
 }
 
 int UPriorityQueue::Pop(UPARAM(ref) bool& Success)
 {
-	if (ContainsSet.IsEmpty())
+	if (IsEmpty())
 	{
 		Success = false;
 		return -80085;
 	}
 	
-	FPriorityQueueNode Node;
-	Array.HeapPop(Node);
-	ContainsSet.Remove(Node.DataInteger);
+	int DataInteger;
+	if (Mode == EPriorityQueueMode::Bounded)
+	{
+		DataInteger = BoundedQueue.Pop();
+	}
+	else
+	{
+		DataInteger = UseRadixQueue() ? RadixQueue.Pop() : Queue.Pop();
+	}
+	HandleMap.Remove(DataInteger);
 
 	Success = true;
-	return Node.DataInteger;
+	return DataInteger;
 }
 
 void UPriorityQueue::Push(int DataInteger, float Cost)
 {
-	ContainsSet.Add(DataInteger);
-	Array.HeapPush(FPriorityQueueNode(DataInteger, Cost));
+	const int32* Handle = HandleMap.Find(DataInteger);
+
+	if (Mode == EPriorityQueueMode::Bounded)
+	{
+		if (Handle)
+		{
+			BoundedQueue.UpdateCost(*Handle, Cost);
+			return;
+		}
+
+		if (MaxSize > 0 && BoundedQueue.Num() >= MaxSize)
+		{
+			if (!(Cost < BoundedQueue.BottomCost()))
+			{
+				return;
+			}
+			TrimBoundedQueue(MaxSize - 1);
+		}
+		HandleMap.Add(DataInteger, BoundedQueue.Push(DataInteger, Cost));
+		return;
+	}
+
+	if (UseRadixQueue())
+	{
+		if (RadixQueue.CanAccept(Cost))
+		{
+			if (Handle)
+			{
+				RadixQueue.UpdateCost(*Handle, Cost);
+			}
+			else
+			{
+				HandleMap.Add(DataInteger, RadixQueue.Push(DataInteger, Cost));
+			}
+			return;
+		}
+
+		FallBackToBinaryHeap();
+		Handle = HandleMap.Find(DataInteger);
+	}
+
+	if (Handle)
+	{
+		Queue.UpdateCost(*Handle, Cost);
+		return;
+	}
+
+	HandleMap.Add(DataInteger, Queue.Push(DataInteger, Cost));
 }
 
 void UPriorityQueue::Remove(int DataInteger)
 {
-	for (int i = 0; i < Array.Num(); i++)
+	int32 Handle;
+	if (HandleMap.RemoveAndCopyValue(DataInteger, Handle))
 	{
-		if (Array[i].DataInteger == DataInteger)
+		if (Mode == EPriorityQueueMode::Bounded)
+		{
+			BoundedQueue.Remove(Handle);
+		}
+		else if (UseRadixQueue())
 		{
-			Array.HeapRemoveAt(i);
-			ContainsSet.Remove(DataInteger);
-			break;
+			RadixQueue.Remove(Handle);
+		}
+		else
+		{
+			Queue.Remove(Handle);
 		}
 	}
 }
 
 void UPriorityQueue::Replace(int DataInteger, float NewCost)
 {
-	for (int i = 0; i < Array.Num(); i++)
+	if (HandleMap.Contains(DataInteger))
+	{
+		Push(DataInteger, NewCost);
+	}
+}
+
+void UPriorityQueue::PushBatch(const TArray<int>& Data, const TArray<float>& Costs)
+{
+	if (Data.Num() != Costs.Num())
 	{
-		if (Array[i].DataInteger == DataInteger)
+		UE_LOG(LogTemp, Warning, TEXT("PushBatch: Data and Costs must have the same length (%d vs %d)."), Data.Num(), Costs.Num());
+		return;
+	}
+
+	const int32 TotalNum = HandleMap.Num() + Data.Num();
+
+	if (Mode == EPriorityQueueMode::Bounded)
+	{
+		// Bounded pushes cost O(log K) and most of a large batch is rejected without allocating anything
+		for (int32 i = 0; i < Data.Num(); ++i)
 		{
-			Array[i].Cost = NewCost;
-			break;
+			Push(Data[i], Costs[i]);
 		}
+		return;
 	}
 
-	Array.HeapSort();
+	HandleMap.Reserve(TotalNum);
+
+	if (UseRadixQueue())
+	{
+		// Radix pushes are already O(1), Push handles the fallback if a cost breaks monotonicity
+		RadixQueue.Reserve(TotalNum);
+		for (int32 i = 0; i < Data.Num(); ++i)
+		{
+			Push(Data[i], Costs[i]);
+		}
+		return;
+	}
+
+	Queue.Reserve(TotalNum);
+
+	// A few pushes onto a big queue are cheaper as individual sifts than rebuilding the whole heap
+	if (Data.Num() * FMath::FloorLog2(FMath::Max(TotalNum, 2)) < TotalNum)
+	{
+		for (int32 i = 0; i < Data.Num(); ++i)
+		{
+			Push(Data[i], Costs[i]);
+		}
+		return;
+	}
+
+	for (int32 i = 0; i < Data.Num(); ++i)
+	{
+		if (const int32* Handle = HandleMap.Find(Data[i]))
+		{
+			Queue.UpdateCostUnordered(*Handle, Costs[i]);
+		}
+		else
+		{
+			HandleMap.Add(Data[i], Queue.EmplaceUnordered(Costs[i], Data[i]));
+		}
+	}
+	Queue.Heapify();
+}
+
+void UPriorityQueue::BuildFromArrays(const TArray<int>& Data, const TArray<float>& Costs)
+{
+	Queue.Reset();
+	RadixQueue.Reset();
+	BoundedQueue.Reset();
+	HandleMap.Reset();
+	bMonotoneFallback = false;
+	PushBatch(Data, Costs);
+}
+
+TArray<int> UPriorityQueue::PopBatch(int32 Count)
+{
+	TArray<int> Result;
+	if (Mode == EPriorityQueueMode::Bounded)
+	{
+		Count = FMath::Clamp(Count, 0, BoundedQueue.Num());
+		Result.Reserve(Count);
+		for (int32 i = 0; i < Count; ++i)
+		{
+			Result.Add(BoundedQueue.Pop());
+		}
+	}
+	else if (UseRadixQueue())
+	{
+		Count = FMath::Clamp(Count, 0, RadixQueue.Num());
+		Result.Reserve(Count);
+		for (int32 i = 0; i < Count; ++i)
+		{
+			Result.Add(RadixQueue.Pop());
+		}
+	}
+	else
+	{
+		Queue.PopMany(Count, Result);
+	}
+
+	if (IsEmpty())
+	{
+		HandleMap.Reset();
+	}
+	else
+	{
+		for (const int DataInteger : Result)
+		{
+			HandleMap.Remove(DataInteger);
+		}
+	}
+	return Result;
+}
+
+int UPriorityQueue::PeekBest(bool& Success, float& Cost)
+{
+	Success = !IsEmpty();
+	if (!Success)
+	{
+		Cost = 0.f;
+		return -80085;
+	}
+
+	if (Mode == EPriorityQueueMode::Bounded)
+	{
+		Cost = BoundedQueue.TopCost();
+		return BoundedQueue.Top();
+	}
+	if (UseRadixQueue())
+	{
+		Cost = RadixQueue.TopCost();
+		return RadixQueue.Top();
+	}
+	Cost = Queue.TopCost();
+	return Queue.Top();
+}
+
+int UPriorityQueue::PeekWorst(bool& Success, float& Cost)
+{
+	Success = Mode == EPriorityQueueMode::Bounded && !BoundedQueue.IsEmpty();
+	if (!Success)
+	{
+		Cost = 0.f;
+		return -80085;
+	}
+
+	Cost = BoundedQueue.BottomCost();
+	return BoundedQueue.Bottom();
+}
+
+int UPriorityQueue::PopWorst(bool& Success)
+{
+	Success = Mode == EPriorityQueueMode::Bounded && !BoundedQueue.IsEmpty();
+	if (!Success)
+	{
+		return -80085;
+	}
+
+	const int DataInteger = BoundedQueue.PopBottom();
+	HandleMap.Remove(DataInteger);
+	return DataInteger;
 }
 
 bool UPriorityQueue::Contains(int DataInteger)
 {
-	return ContainsSet.Contains(DataInteger);
+	return HandleMap.Contains(DataInteger);
 }
 
 bool UPriorityQueue::IsEmpty() const
 {
-	return Array.Num() == 0;
-}
\ No newline at end of file
+	return Queue.IsEmpty() && RadixQueue.IsEmpty() && BoundedQueue.IsEmpty();
+}
+
+bool UPriorityQueue::UseRadixQueue()
+{
+	if (Mode != EPriorityQueueMode::Monotone)
+	{
+		return false;
+	}
+
+	if (bMonotoneFallback && Queue.IsEmpty())
+	{
+		bMonotoneFallback = false;
+	}
+	return !bMonotoneFallback;
+}
+
+void UPriorityQueue::FallBackToBinaryHeap()
+{
+	Queue.Reserve(Queue.Num() + RadixQueue.Num());
+	RadixQueue.DrainUnordered([this](int DataInteger, float Cost)
+	{
+		HandleMap[DataInteger] = Queue.EmplaceUnordered(Cost, DataInteger);
+	});
+	Queue.Heapify();
+	bMonotoneFallback = Mode == EPriorityQueueMode::Monotone;
+}
+
+void UPriorityQueue::TrimBoundedQueue(int32 Capacity)
+{
+	while (BoundedQueue.Num() > FMath::Max(Capacity, 0))
+	{
+		HandleMap.Remove(BoundedQueue.PopBottom());
+	}
+}
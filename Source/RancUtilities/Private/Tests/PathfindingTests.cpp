@@ -0,0 +1,303 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "Algo/Count.h"
+#include "Misc/AutomationTest.h"
+#include "RancFlowField.h"
+#include "RancGridPathfinder.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Grid of cost 1 cells where each cell is blocked with probability BlockedFraction
+	FRancCostGrid MakeRandomCostGrid(FRandomStream& Stream, int32 Width, int32 Height, float BlockedFraction)
+	{
+		FRancCostGrid Grid;
+		Grid.Init(Width, Height);
+		for (uint8& Cost : Grid.Costs)
+		{
+			Cost = Stream.FRand() < BlockedFraction ? 0 : 1;
+		}
+		return Grid;
+	}
+
+	FIntVector2D GetRandomWalkableCell(FRandomStream& Stream, const FRancCostGrid& Grid)
+	{
+		while (true)
+		{
+			const FIntVector2D Cell(Stream.RandRange(0, Grid.Width - 1), Stream.RandRange(0, Grid.Height - 1));
+			if (Grid.IsWalkable(Cell))
+			{
+				return Cell;
+			}
+		}
+	}
+
+	// Cost of walking Path one cell at a time, or a negative value if a step is not a legal 8-connected move
+	float GetGridPathCost(const FRancCostGrid& Grid, const TArray<FIntVector2D>& Path)
+	{
+		float Cost = 0.f;
+		for (int32 i = 1; i < Path.Num(); ++i)
+		{
+			const FIntVector2D From = Path[i - 1];
+			const FIntVector2D To = Path[i];
+			const int32 DX = To.X - From.X;
+			const int32 DY = To.Y - From.Y;
+			if (FMath::Max(FMath::Abs(DX), FMath::Abs(DY)) != 1 || !Grid.IsWalkable(To))
+			{
+				return -1.f;
+			}
+
+			const bool bDiagonal = DX != 0 && DY != 0;
+			if (bDiagonal && (!Grid.IsWalkable(To.X, From.Y) || !Grid.IsWalkable(From.X, To.Y)))
+			{
+				return -1.f;
+			}
+			Cost += Grid.Costs[Grid.ToIndex(To)] * (bDiagonal ? RancGrid::Sqrt2 : 1.f);
+		}
+		return Cost;
+	}
+
+	// Index of the first cell where Incremental and Rebuilt integrate to different costs, INDEX_NONE if they agree
+	int32 FindFlowFieldMismatch(const URancFlowField& Incremental, const URancFlowField& Rebuilt)
+	{
+		const TArray<float>& IncrementalCosts = Incremental.GetIntegrationField();
+		const TArray<float>& RebuiltCosts = Rebuilt.GetIntegrationField();
+		for (int32 i = 0; i < RebuiltCosts.Num(); ++i)
+		{
+			const bool bIncrementalReachable = IncrementalCosts[i] != TNumericLimits<float>::Max();
+			const bool bRebuiltReachable = RebuiltCosts[i] != TNumericLimits<float>::Max();
+			// Equal cost routes can be summed in a different order, so allow for float rounding
+			if (bIncrementalReachable != bRebuiltReachable || (bRebuiltReachable && !FMath::IsNearlyEqual(IncrementalCosts[i], RebuiltCosts[i], 1e-2f)))
+			{
+				return i;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	// Index of the first reachable cell whose direction doesn't lead to a neighbour explaining its cost, INDEX_NONE if none
+	int32 FindInconsistentFlowDirection(const URancFlowField& FlowField)
+	{
+		const FRancCostGrid& Grid = FlowField.GetGrid();
+		const TArray<float>& Costs = FlowField.GetIntegrationField();
+		const TArray<int8>& Directions = FlowField.GetDirectionField();
+		for (int32 i = 0; i < Costs.Num(); ++i)
+		{
+			if (Costs[i] == TNumericLimits<float>::Max() || Costs[i] == 0.f)
+			{
+				continue;
+			}
+
+			const int32 Direction = Directions[i];
+			const FIntVector2D Cell = Grid.ToCell(i);
+			if (Direction == INDEX_NONE || !Grid.CanStep(Cell.X, Cell.Y, Direction))
+			{
+				return i;
+			}
+
+			const int32 NextIndex = Grid.ToIndex(Cell.X + RancGrid::DirX[Direction], Cell.Y + RancGrid::DirY[Direction]);
+			const float StepCost = Grid.Costs[NextIndex] * (RancGrid::IsDiagonal(Direction) ? RancGrid::Sqrt2 : 1.f);
+			if (!FMath::IsNearlyEqual(Costs[i], Costs[NextIndex] + StepCost, 1e-2f))
+			{
+				return i;
+			}
+		}
+		return INDEX_NONE;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancJumpPointSearchTest, "RancUtilities.Pathfinding.JumpPointSearchMatchesAStar",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancJumpPointSearchTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Stream(1701);
+	URancGridPathfinder* AStar = NewObject<URancGridPathfinder>(GetTransientPackage());
+	URancGridPathfinder* JumpPoint = NewObject<URancGridPathfinder>(GetTransientPackage());
+	AStar->Algorithm = ERancPathfindingAlgorithm::AStar;
+	JumpPoint->Algorithm = ERancPathfindingAlgorithm::JumpPointSearch;
+
+	// Dense obstacles give many forced neighbours and blocked corners, the part of JPS most likely to go wrong
+	for (const float BlockedFraction : {0.1f, 0.25f, 0.4f})
+	{
+		const FRancCostGrid Grid = MakeRandomCostGrid(Stream, 48, 40, BlockedFraction);
+		AStar->SetGrid(Grid);
+		JumpPoint->SetGrid(Grid);
+
+		for (int32 Query = 0; Query < 100; ++Query)
+		{
+			const FIntVector2D Start = GetRandomWalkableCell(Stream, Grid);
+			const FIntVector2D Goal = GetRandomWalkableCell(Stream, Grid);
+			const FString What = FString::Printf(TEXT("%.2f blocked, (%s) to (%s)"), BlockedFraction, *Start.ToString(), *Goal.ToString());
+
+			TArray<FIntVector2D> AStarPath;
+			TArray<FIntVector2D> JumpPointPath;
+			const bool bAStarFound = AStar->FindPath(Start, Goal, AStarPath);
+			const bool bJumpPointFound = JumpPoint->FindPath(Start, Goal, JumpPointPath);
+			if (!TestEqual(What + TEXT(": found"), bJumpPointFound, bAStarFound) || !bAStarFound)
+			{
+				continue;
+			}
+
+			TestTrue(What + TEXT(": JPS path starts at the start"), JumpPointPath.Num() > 0 && JumpPointPath[0] == Start);
+			TestTrue(What + TEXT(": JPS path ends at the goal"), JumpPointPath.Num() > 0 && JumpPointPath.Last() == Goal);
+			const float AStarCost = GetGridPathCost(Grid, AStarPath);
+			const float JumpPointCost = GetGridPathCost(Grid, JumpPointPath);
+			TestTrue(What + TEXT(": A* path is legal"), AStarCost >= 0.f);
+			TestTrue(What + TEXT(": JPS path is legal"), JumpPointCost >= 0.f);
+			TestEqual(What + TEXT(": JPS cost"), JumpPointCost, AStarCost, 1e-3f);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancGridPathfinderPerfTest, "RancUtilities.Pathfinding.GridPathfinderPerformance",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRancGridPathfinderPerfTest::RunTest(const FString& Parameters)
+{
+	for (const int32 Size : {512, 2048})
+	{
+		FRandomStream Stream(Size);
+		const FRancCostGrid Grid = MakeRandomCostGrid(Stream, Size, Size, 0.2f);
+		URancGridPathfinder* Pathfinder = NewObject<URancGridPathfinder>(GetTransientPackage());
+		Pathfinder->SetGrid(Grid);
+
+		// Long queries, so the open list and not the setup dominates
+		const int32 NumQueries = Size >= 2048 ? 16 : 64;
+		TArray<FIntVector2D> Starts;
+		TArray<FIntVector2D> Goals;
+		for (int32 Query = 0; Query < NumQueries; ++Query)
+		{
+			Starts.Add(GetRandomWalkableCell(Stream, Grid));
+			Goals.Add(GetRandomWalkableCell(Stream, Grid));
+		}
+
+		TArray<FIntVector2D> Path;
+		int32 NumAStarFound = 0;
+		Pathfinder->Algorithm = ERancPathfindingAlgorithm::AStar;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; ++Query)
+		{
+			NumAStarFound += Pathfinder->FindPath(Starts[Query], Goals[Query], Path) ? 1 : 0;
+		}
+		const double AStarTime = FPlatformTime::Seconds() - StartTime;
+
+		int32 NumJumpPointFound = 0;
+		Pathfinder->Algorithm = ERancPathfindingAlgorithm::JumpPointSearch;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; ++Query)
+		{
+			NumJumpPointFound += Pathfinder->FindPath(Starts[Query], Goals[Query], Path) ? 1 : 0;
+		}
+		const double JumpPointTime = FPlatformTime::Seconds() - StartTime;
+
+		TArray<FRancGridPath> Paths;
+		StartTime = FPlatformTime::Seconds();
+		Pathfinder->FindPaths(Starts, Goals, Paths);
+		const double BatchTime = FPlatformTime::Seconds() - StartTime;
+
+		const int32 NumBatchFound = Algo::CountIf(Paths, [](const FRancGridPath& GridPath) { return GridPath.bFound; });
+		TestEqual(FString::Printf(TEXT("%dx%d: JPS finds the same paths as A*"), Size, Size), NumJumpPointFound, NumAStarFound);
+		TestEqual(FString::Printf(TEXT("%dx%d: FindPaths finds the same paths as FindPath"), Size, Size), NumBatchFound, NumJumpPointFound);
+
+		AddInfo(FString::Printf(TEXT("%dx%d, %d queries: A* %.2f ms, JPS %.2f ms, JPS FindPaths %.2f ms"),
+			Size, Size, NumQueries, AStarTime * 1000.0, JumpPointTime * 1000.0, BatchTime * 1000.0));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancFlowFieldIncrementalTest, "RancUtilities.Pathfinding.FlowFieldIncrementalMatchesRebuild",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancFlowFieldIncrementalTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Stream(2024);
+	FRancCostGrid Grid;
+	Grid.Init(64, 48);
+	for (uint8& Cost : Grid.Costs)
+	{
+		Cost = Stream.FRand() < 0.2f ? 0 : static_cast<uint8>(Stream.RandRange(1, 4));
+	}
+
+	TArray<FIntVector2D> Goals;
+	for (int32 i = 0; i < 3; ++i)
+	{
+		Goals.Add(FIntVector2D(Stream.RandRange(0, Grid.Width - 1), Stream.RandRange(0, Grid.Height - 1)));
+	}
+	URancFlowField* Incremental = URancFlowField::CreateFlowField(GetTransientPackage(), Grid, Goals);
+
+	// Blocking, opening, raising and lowering cells, goals included, several at a time
+	const TArray<uint8> CostChoices = {0, 0, 1, 2, 9};
+	for (int32 Round = 0; Round < 60; ++Round)
+	{
+		TArray<FIntVector2D> Cells;
+		TArray<uint8> Costs;
+		const int32 NumChanges = Stream.RandRange(1, 8);
+		for (int32 i = 0; i < NumChanges; ++i)
+		{
+			Cells.Add(Round % 5 == 0 ? Goals[i % Goals.Num()] : FIntVector2D(Stream.RandRange(0, Grid.Width - 1), Stream.RandRange(0, Grid.Height - 1)));
+			Costs.Add(CostChoices[Stream.RandRange(0, CostChoices.Num() - 1)]);
+		}
+		Incremental->SetCellCosts(Cells, Costs);
+
+		const URancFlowField* Rebuilt = URancFlowField::CreateFlowField(GetTransientPackage(), Incremental->GetGrid(), Goals);
+		const int32 Mismatch = FindFlowFieldMismatch(*Incremental, *Rebuilt);
+		if (Mismatch != INDEX_NONE)
+		{
+			AddError(FString::Printf(TEXT("Round %d: cell (%s) integrates to %f, a rebuild gives %f"), Round, *Grid.ToCell(Mismatch).ToString(),
+				Incremental->GetIntegrationField()[Mismatch], Rebuilt->GetIntegrationField()[Mismatch]));
+			break;
+		}
+
+		const int32 Inconsistent = FindInconsistentFlowDirection(*Incremental);
+		if (Inconsistent != INDEX_NONE)
+		{
+			AddError(FString::Printf(TEXT("Round %d: the direction of cell (%s) doesn't match its cost"), Round, *Grid.ToCell(Inconsistent).ToString()));
+			break;
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancFlowFieldPerfTest, "RancUtilities.Pathfinding.FlowFieldPerformance",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRancFlowFieldPerfTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Stream(512);
+	const FRancCostGrid Grid = MakeRandomCostGrid(Stream, 1024, 1024, 0.1f);
+	URancFlowField* FlowField = NewObject<URancFlowField>(GetTransientPackage());
+
+	for (const int32 NumGoals : {256, 1024, 4096})
+	{
+		TArray<FIntVector2D> Goals;
+		for (int32 i = 0; i < NumGoals; ++i)
+		{
+			Goals.Add(GetRandomWalkableCell(Stream, Grid));
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		FlowField->Build(Grid, Goals);
+		const double BuildTime = FPlatformTime::Seconds() - StartTime;
+
+		// Toggling single cells, like a door closing and opening again
+		constexpr int32 NumToggles = 32;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumToggles; ++i)
+		{
+			const FIntVector2D Cell = GetRandomWalkableCell(Stream, Grid);
+			FlowField->SetCellCost(Cell, 0);
+			FlowField->SetCellCost(Cell, 1);
+		}
+		const double ToggleTime = (FPlatformTime::Seconds() - StartTime) / (NumToggles * 2);
+
+		AddInfo(FString::Printf(TEXT("1024x1024, %d goals: Build %.2f ms, SetCellCost %.3f ms on average"),
+			NumGoals, BuildTime * 1000.0, ToggleTime * 1000.0));
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,307 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "Async/Async.h"
+#include "Misc/AutomationTest.h"
+#include "TConcurrentPriorityQueue.h"
+#include "TPriorityQueue.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Pops the whole queue and checks every expected DataInteger comes out once, in cost order
+	void TestPopsInCostOrder(FAutomationTestBase& Test, const FString& What, UPriorityQueue* Queue, const TMap<int, float>& Expected)
+	{
+		TSet<int> Popped;
+		float LastCost = -UE_BIG_NUMBER;
+		bool bSuccess = true;
+		while (!Queue->IsEmpty())
+		{
+			const int DataInteger = Queue->Pop(bSuccess);
+			const float* Cost = Expected.Find(DataInteger);
+			if (!Test.TestNotNull(FString::Printf(TEXT("%s: popped %d was pushed"), *What, DataInteger), Cost))
+			{
+				return;
+			}
+			bool bAlreadyPopped = false;
+			Popped.Add(DataInteger, &bAlreadyPopped);
+			Test.TestFalse(FString::Printf(TEXT("%s: %d is popped once"), *What, DataInteger), bAlreadyPopped);
+			Test.TestTrue(FString::Printf(TEXT("%s: %d is popped in cost order"), *What, DataInteger), *Cost >= LastCost);
+			LastCost = *Cost;
+		}
+		Test.TestEqual(FString::Printf(TEXT("%s: pop count"), *What), Popped.Num(), Expected.Num());
+	}
+
+	// Runs Producer(ThreadIndex) on NumThreads dedicated threads released together, returns the wall time until all are done
+	double RunProducerThreads(int32 NumThreads, TFunctionRef<void(int32)> Producer)
+	{
+		std::atomic<bool> bStart(false);
+		TArray<TFuture<void>> Futures;
+		for (int32 ThreadIndex = 0; ThreadIndex < NumThreads; ++ThreadIndex)
+		{
+			Futures.Add(Async(EAsyncExecution::Thread, [&bStart, Producer, ThreadIndex]()
+			{
+				while (!bStart.load(std::memory_order_acquire))
+				{
+					FPlatformProcess::Yield();
+				}
+				Producer(ThreadIndex);
+			}));
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		bStart.store(true, std::memory_order_release);
+		for (TFuture<void>& Future : Futures)
+		{
+			Future.Wait();
+		}
+		return FPlatformTime::Seconds() - StartTime;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancPriorityQueuePushUpdateTest, "RancUtilities.PriorityQueue.PushUpdatesExistingKey",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancPriorityQueuePushUpdateTest::RunTest(const FString& Parameters)
+{
+	for (const EPriorityQueueMode Mode : {EPriorityQueueMode::BinaryHeap, EPriorityQueueMode::Monotone, EPriorityQueueMode::Bounded})
+	{
+		const FString ModeName = StaticEnum<EPriorityQueueMode>()->GetNameStringByValue(static_cast<int64>(Mode));
+		UPriorityQueue* Queue = NewObject<UPriorityQueue>(GetTransientPackage());
+		Queue->SetMode(Mode);
+		Queue->SetMaxSize(0);
+
+		// Pushing a queued DataInteger again moves it rather than adding a second entry
+		Queue->Push(1, 5.f);
+		Queue->Push(2, 3.f);
+		Queue->Push(3, 8.f);
+		Queue->Push(3, 1.f);
+		Queue->Push(2, 10.f);
+		bool bSuccess = false;
+		float Cost = 0.f;
+		TestEqual(FString::Printf(TEXT("%s: decreased key is the best"), *ModeName), Queue->PeekBest(bSuccess, Cost), 3);
+		TestEqual(FString::Printf(TEXT("%s: decreased key cost"), *ModeName), Cost, 1.f);
+		TestPopsInCostOrder(*this, ModeName + TEXT(" small"), Queue, {{3, 1.f}, {1, 5.f}, {2, 10.f}});
+
+		// Random pushes over few keys, so most of them update a queued key, mixed with batches and removals
+		FRandomStream Stream(4242);
+		TMap<int, float> Expected;
+		for (int32 Round = 0; Round < 200; ++Round)
+		{
+			if (Round % 10 == 0)
+			{
+				TArray<int> Data;
+				TArray<float> Costs;
+				for (int32 i = 0; i < 20; ++i)
+				{
+					Data.Add(Stream.RandRange(0, 63));
+					Costs.Add(Stream.FRandRange(0.f, 100.f));
+					Expected.Add(Data.Last(), Costs.Last());
+				}
+				Queue->PushBatch(Data, Costs);
+			}
+			else if (Round % 7 == 0)
+			{
+				const int DataInteger = Stream.RandRange(0, 63);
+				Queue->Remove(DataInteger);
+				Expected.Remove(DataInteger);
+			}
+			else
+			{
+				const int DataInteger = Stream.RandRange(0, 63);
+				const float NewCost = Stream.FRandRange(0.f, 100.f);
+				Queue->Push(DataInteger, NewCost);
+				Expected.Add(DataInteger, NewCost);
+			}
+		}
+		for (const TPair<int, float>& Pair : Expected)
+		{
+			TestTrue(FString::Printf(TEXT("%s: contains %d"), *ModeName, Pair.Key), Queue->Contains(Pair.Key));
+		}
+		TestPopsInCostOrder(*this, ModeName + TEXT(" random"), Queue, Expected);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancPriorityQueueBatchPerfTest, "RancUtilities.PriorityQueue.BatchPerformance",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRancPriorityQueueBatchPerfTest::RunTest(const FString& Parameters)
+{
+	for (const int32 Num : {10000, 100000, 1000000})
+	{
+		FRandomStream Stream(Num);
+		TArray<int> Data;
+		TArray<float> Costs;
+		Data.SetNumUninitialized(Num);
+		Costs.SetNumUninitialized(Num);
+		for (int32 i = 0; i < Num; ++i)
+		{
+			Data[i] = i;
+			Costs[i] = Stream.FRandRange(0.f, 1000.f);
+		}
+
+		// 30% of the pushes lower the cost of an element that is already queued
+		const int32 NumUpdates = Num * 3 / 10;
+		TArray<int> UpdateData;
+		TArray<float> UpdateCosts;
+		for (int32 i = 0; i < NumUpdates; ++i)
+		{
+			UpdateData.Add(Stream.RandRange(0, Num - 1));
+			UpdateCosts.Add(Costs[UpdateData.Last()] * Stream.FRand());
+		}
+
+		UPriorityQueue* SingleQueue = NewObject<UPriorityQueue>(GetTransientPackage());
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Num; ++i)
+		{
+			SingleQueue->Push(Data[i], Costs[i]);
+		}
+		for (int32 i = 0; i < NumUpdates; ++i)
+		{
+			SingleQueue->Push(UpdateData[i], UpdateCosts[i]);
+		}
+		const double SinglePushTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		TArray<int> SinglePopped;
+		SinglePopped.Reserve(Num);
+		bool bSuccess = true;
+		while (!SingleQueue->IsEmpty())
+		{
+			SinglePopped.Add(SingleQueue->Pop(bSuccess));
+		}
+		const double SinglePopTime = FPlatformTime::Seconds() - StartTime;
+
+		UPriorityQueue* BatchQueue = NewObject<UPriorityQueue>(GetTransientPackage());
+		StartTime = FPlatformTime::Seconds();
+		BatchQueue->BuildFromArrays(Data, Costs);
+		BatchQueue->PushBatch(UpdateData, UpdateCosts);
+		const double BatchPushTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		const TArray<int> BatchPopped = BatchQueue->PopBatch(Num);
+		const double BatchPopTime = FPlatformTime::Seconds() - StartTime;
+
+		TestEqual(FString::Printf(TEXT("%d: pop counts match"), Num), BatchPopped.Num(), SinglePopped.Num());
+		TestTrue(FString::Printf(TEXT("%d: queues are drained"), Num), SingleQueue->IsEmpty() && BatchQueue->IsEmpty());
+
+		AddInfo(FString::Printf(TEXT("%d elements, %d decrease-keys: Push %.2f ms, BuildFromArrays + PushBatch %.2f ms, Pop %.2f ms, PopBatch %.2f ms"),
+			Num, NumUpdates, SinglePushTime * 1000.0, BatchPushTime * 1000.0, SinglePopTime * 1000.0, BatchPopTime * 1000.0));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancConcurrentPriorityQueueTest, "RancUtilities.PriorityQueue.ConcurrentProducers",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancConcurrentPriorityQueueTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumProducers = 8;
+	constexpr int32 NumPerProducer = 20000;
+	constexpr int32 NumElements = NumProducers * NumPerProducer;
+
+	// Fewer shards than producers, so producers contend and flushes race with pushes into the same shard
+	TConcurrentPriorityQueue<int32> Queue(3);
+	TBitArray<> Seen(false, NumElements);
+	int32 NumPopped = 0;
+	int32 NumDuplicates = 0;
+	auto Consume = [&](int32 Element)
+	{
+		NumDuplicates += Seen[Element] ? 1 : 0;
+		Seen[Element] = true;
+		++NumPopped;
+	};
+
+	std::atomic<int32> NumProducersDone(0);
+	TFuture<double> Producers = Async(EAsyncExecution::Thread, [&Queue, &NumProducersDone]()
+	{
+		return RunProducerThreads(NumProducers, [&Queue, &NumProducersDone](int32 Producer)
+		{
+			FRandomStream Stream(Producer + 1);
+			for (int32 i = 0; i < NumPerProducer; ++i)
+			{
+				Queue.Push(Producer * NumPerProducer + i, Stream.FRand());
+			}
+			NumProducersDone.fetch_add(1);
+		});
+	});
+
+	// Drain while the producers are still pushing
+	int32 Element;
+	while (NumProducersDone.load() < NumProducers)
+	{
+		if (Queue.TryPop(Element))
+		{
+			Consume(Element);
+		}
+	}
+	Producers.Wait();
+
+	// Once every push has returned, the rest must come out in cost order
+	float Cost = 0.f;
+	float LastCost = -1.f;
+	bool bOrdered = true;
+	while (Queue.TryPop(Element, Cost))
+	{
+		Consume(Element);
+		bOrdered &= Cost >= LastCost;
+		LastCost = Cost;
+	}
+
+	TestEqual(TEXT("Every pushed element is popped"), NumPopped, NumElements);
+	TestEqual(TEXT("No element is popped twice"), NumDuplicates, 0);
+	TestTrue(TEXT("Every element is seen"), Seen.CountSetBits() == NumElements);
+	TestTrue(TEXT("Completed pushes pop in cost order"), bOrdered);
+	TestEqual(TEXT("NumPending ends at 0"), Queue.GetNumPending(), 0);
+	TestTrue(TEXT("The queue ends empty"), Queue.IsEmpty());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancConcurrentPriorityQueuePerfTest, "RancUtilities.PriorityQueue.ConcurrentContention",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRancConcurrentPriorityQueuePerfTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumElements = 1 << 20;
+	for (const int32 NumThreads : {2, 4, 8, 16, 32})
+	{
+		const int32 NumPerThread = NumElements / NumThreads;
+
+		TConcurrentPriorityQueue<int32> Queue;
+		const double ShardedTime = RunProducerThreads(NumThreads, [&Queue, NumPerThread](int32 ThreadIndex)
+		{
+			FRandomStream Stream(ThreadIndex);
+			for (int32 i = 0; i < NumPerThread; ++i)
+			{
+				Queue.Push(ThreadIndex * NumPerThread + i, Stream.FRand());
+			}
+		});
+
+		double StartTime = FPlatformTime::Seconds();
+		TArray<int32> Popped;
+		Queue.PopMany(NumElements, Popped);
+		const double DrainTime = FPlatformTime::Seconds() - StartTime;
+
+		// Baseline: one heap behind one lock
+		FCriticalSection LockedHeapLock;
+		TIndexedPriorityQueue<int32, float> LockedHeap;
+		const double LockedTime = RunProducerThreads(NumThreads, [&LockedHeapLock, &LockedHeap, NumPerThread](int32 ThreadIndex)
+		{
+			FRandomStream Stream(ThreadIndex);
+			for (int32 i = 0; i < NumPerThread; ++i)
+			{
+				FScopeLock Lock(&LockedHeapLock);
+				LockedHeap.Push(ThreadIndex * NumPerThread + i, Stream.FRand());
+			}
+		});
+
+		TestEqual(FString::Printf(TEXT("%d threads: every push is popped"), NumThreads), Popped.Num(), NumPerThread * NumThreads);
+		AddInfo(FString::Printf(TEXT("%d threads, %d pushes: sharded %.2f ms (+ %.2f ms drain), single lock %.2f ms"),
+			NumThreads, NumPerThread * NumThreads, ShardedTime * 1000.0, DrainTime * 1000.0, LockedTime * 1000.0));
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,80 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "ISortableElement.h"
+#include "ISortKeyProvider.h"
+#include "WeightedRandomSelector.h"
+#include "RancTestObjects.generated.h"
+
+// Objects used by the automation tests in this folder
+
+// GetWeight is a BlueprintNativeEvent, so each read goes through Execute_GetWeight and ProcessEvent like a Blueprint
+// implementation would. Counts how often its weight was read.
+UCLASS(Transient, HideDropdown)
+class URancTestWeightedItem : public UObject, public IWeightedItem
+{
+	GENERATED_BODY()
+
+public:
+	virtual float GetWeight_Implementation() const override
+	{
+		++NumGetWeightCalls;
+		return Weight;
+	}
+
+	float Weight = 1.f;
+	mutable int32 NumGetWeightCalls = 0;
+};
+
+// Orders by Key both through ISortKeyProvider and through ISortableElement, counting the calls to each
+UCLASS(Transient, HideDropdown)
+class URancTestSortKeyObject : public UObject, public ISortKeyProvider, public ISortableElement
+{
+	GENERATED_BODY()
+
+public:
+	virtual FRancSortKey GetSortKey_Implementation() const override
+	{
+		++NumGetSortKeyCalls;
+		return Key;
+	}
+
+	virtual bool IsLessThan_Implementation(const UObject* Other) const override
+	{
+		++NumIsLessThanCalls;
+		const URancTestSortKeyObject* OtherObject = Cast<URancTestSortKeyObject>(Other);
+		return OtherObject && Key < OtherObject->Key;
+	}
+
+	FRancSortKey Key;
+	mutable int32 NumGetSortKeyCalls = 0;
+	mutable int32 NumIsLessThanCalls = 0;
+};
+
+// Sort properties for SortByProperty
+UCLASS(Transient, HideDropdown)
+class URancTestLevelObject : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	int32 Level = 0;
+
+	UPROPERTY()
+	float Rank = 0.f;
+};
+
+// Level is a string here and there is no Rank, so sorting by Level and Rank rejects this class
+UCLASS(Transient, HideDropdown)
+class URancTestNamedLevelObject : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	FString Level;
+};
@@ -0,0 +1,255 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "Algo/StableSort.h"
+#include "Misc/AutomationTest.h"
+#include "RancRadixSort.h"
+#include "RancSortingLibrary.h"
+#include "RancTestObjects.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	URancTestSortKeyObject* MakeSortKeyObject(const FRancSortKey& Key)
+	{
+		URancTestSortKeyObject* Object = NewObject<URancTestSortKeyObject>(GetTransientPackage());
+		Object->Key = Key;
+		return Object;
+	}
+
+	URancTestLevelObject* MakeLevelObject(int32 Level, float Rank)
+	{
+		URancTestLevelObject* Object = NewObject<URancTestLevelObject>(GetTransientPackage());
+		Object->Level = Level;
+		Object->Rank = Rank;
+		return Object;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancRadixSortTest, "RancUtilities.Sorting.RadixSort", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancRadixSortTest::RunTest(const FString& Parameters)
+{
+	const TArray<float> Keys = {-3.5f, 2.f, -0.25f, 10.f, -100.f, 0.f, 2.f, -3.5f, 1e-20f, -1e20f};
+	FRancRadixSortScratch Scratch;
+
+	for (const bool bDescending : {false, true})
+	{
+		TArray<float> SortedKeys = Keys;
+		TArray<int32> Payloads;
+		for (int32 i = 0; i < Keys.Num(); ++i)
+		{
+			Payloads.Add(i);
+		}
+		RancRadixSort::SortPairs(MakeArrayView(SortedKeys), MakeArrayView(Payloads), Scratch, bDescending);
+
+		// The reference is a stable comparison sort of the indices
+		TArray<int32> Expected;
+		for (int32 i = 0; i < Keys.Num(); ++i)
+		{
+			Expected.Add(i);
+		}
+		Algo::StableSort(Expected, [&Keys, bDescending](int32 A, int32 B) { return bDescending ? Keys[B] < Keys[A] : Keys[A] < Keys[B]; });
+
+		const TCHAR* Order = bDescending ? TEXT("descending") : TEXT("ascending");
+		for (int32 i = 0; i < Keys.Num(); ++i)
+		{
+			TestEqual(FString::Printf(TEXT("Radix payload %d %s"), i, Order), Payloads[i], Expected[i]);
+			TestTrue(FString::Printf(TEXT("Radix key %d %s"), i, Order), SortedKeys[i] == Keys[Expected[i]]);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancSortByKeyTest, "RancUtilities.Sorting.SortByKey", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancSortByKeyTest::RunTest(const FString& Parameters)
+{
+	// Mixed key types order Float < Int < Name, unkeyed objects keep their order at the end
+	URancTestSortKeyObject* Float35 = MakeSortKeyObject(URancSortingLibrary::MakeFloatSortKey(3.5f));
+	URancTestSortKeyObject* NameBeta = MakeSortKeyObject(URancSortingLibrary::MakeNameSortKey(TEXT("beta")));
+	URancTestSortKeyObject* Int10 = MakeSortKeyObject(URancSortingLibrary::MakeIntSortKey(10));
+	URancTestSortKeyObject* FloatMinus1 = MakeSortKeyObject(URancSortingLibrary::MakeFloatSortKey(-1.f));
+	URancTestSortKeyObject* NameAlpha = MakeSortKeyObject(URancSortingLibrary::MakeNameSortKey(TEXT("Alpha")));
+	URancTestSortKeyObject* IntMinus5 = MakeSortKeyObject(URancSortingLibrary::MakeIntSortKey(-5));
+	URancTestSortKeyObject* Float35Tie = MakeSortKeyObject(URancSortingLibrary::MakeFloatSortKey(3.5f));
+	URancTestSortKeyObject* NameGamma = MakeSortKeyObject(URancSortingLibrary::MakeNameSortKey(TEXT("gamma")));
+	UObject* UnkeyedFirst = NewObject<URancTestWeightedItem>(GetTransientPackage());
+	UObject* UnkeyedSecond = NewObject<URancTestWeightedItem>(GetTransientPackage());
+
+	const TArray<UObject*> Objects = {UnkeyedFirst, Float35, NameBeta, nullptr, Int10, FloatMinus1, NameAlpha, UnkeyedSecond, IntMinus5, Float35Tie, NameGamma};
+	const TArray<UObject*> Expected = {FloatMinus1, Float35, Float35Tie, IntMinus5, Int10, NameAlpha, NameBeta, NameGamma, UnkeyedFirst, nullptr, UnkeyedSecond};
+
+	TArray<UObject*> Sorted = Objects;
+	URancSortingLibrary::SortByKey(Sorted);
+	TestTrue(TEXT("SortByKey with mixed key types and unkeyed objects"), Sorted == Expected);
+	for (UObject* Object : Objects)
+	{
+		if (const URancTestSortKeyObject* KeyObject = Cast<URancTestSortKeyObject>(Object))
+		{
+			TestEqual(TEXT("Each key is read once"), KeyObject->NumGetSortKeyCalls, 1);
+		}
+	}
+	TestTrue(TEXT("GetSortedArrayCopyByKey matches SortByKey"), URancSortingLibrary::GetSortedArrayCopyByKey(Objects) == Expected);
+
+	// A single numeric key type takes the radix path, which must keep the same tie order
+	TArray<UObject*> FloatObjects;
+	const FRandomStream Stream(21);
+	for (int32 i = 0; i < 200; ++i)
+	{
+		FloatObjects.Add(MakeSortKeyObject(URancSortingLibrary::MakeFloatSortKey(static_cast<float>(Stream.RandRange(-20, 20)) * 0.5f)));
+	}
+	FloatObjects.Insert(UnkeyedFirst, 100);
+	TArray<UObject*> ExpectedFloats = FloatObjects;
+	ExpectedFloats.RemoveAt(100);
+	Algo::StableSort(ExpectedFloats, [](const UObject* A, const UObject* B)
+	{
+		return CastChecked<URancTestSortKeyObject>(A)->Key < CastChecked<URancTestSortKeyObject>(B)->Key;
+	});
+	ExpectedFloats.Add(UnkeyedFirst);
+	URancSortingLibrary::SortByKey(FloatObjects);
+	TestTrue(TEXT("SortByKey on float keys is stable"), FloatObjects == ExpectedFloats);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancSortByKeyPerfTest, "RancUtilities.Sorting.SortByKeyPerformance", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRancSortByKeyPerfTest::RunTest(const FString& Parameters)
+{
+	for (const int32 Num : {200, 2000, 20000})
+	{
+		const FRandomStream Stream(Num);
+		TArray<UObject*> Objects;
+		TArray<URancTestSortKeyObject*> KeyObjects;
+		for (int32 i = 0; i < Num; ++i)
+		{
+			URancTestSortKeyObject* Object = MakeSortKeyObject(URancSortingLibrary::MakeFloatSortKey(Stream.FRandRange(0.f, 1000.f)));
+			KeyObjects.Add(Object);
+			Objects.Add(Object);
+		}
+
+		TArray<UObject*> ComparatorSorted = Objects;
+		double StartTime = FPlatformTime::Seconds();
+		URancSortingLibrary::SortSortableArray(ComparatorSorted);
+		const double ComparatorTime = FPlatformTime::Seconds() - StartTime;
+
+		TArray<UObject*> KeySorted = Objects;
+		StartTime = FPlatformTime::Seconds();
+		URancSortingLibrary::SortByKey(KeySorted);
+		const double KeyTime = FPlatformTime::Seconds() - StartTime;
+
+		int64 NumIsLessThanCalls = 0;
+		int64 NumGetSortKeyCalls = 0;
+		for (const URancTestSortKeyObject* Object : KeyObjects)
+		{
+			NumIsLessThanCalls += Object->NumIsLessThanCalls;
+			NumGetSortKeyCalls += Object->NumGetSortKeyCalls;
+		}
+
+		// Equal keys may come out in either order from the comparator path
+		bool bSameKeys = ComparatorSorted.Num() == KeySorted.Num();
+		for (int32 i = 0; bSameKeys && i < KeySorted.Num(); ++i)
+		{
+			bSameKeys = CastChecked<URancTestSortKeyObject>(ComparatorSorted[i])->Key.FloatKey == CastChecked<URancTestSortKeyObject>(KeySorted[i])->Key.FloatKey;
+		}
+		TestTrue(FString::Printf(TEXT("%d objects: both paths sort the same"), Num), bSameKeys);
+		AddInfo(FString::Printf(TEXT("%d objects: SortSortableArray %.2f ms (%lld IsLessThan calls), SortByKey %.2f ms (%lld GetSortKey calls)"),
+			Num, ComparatorTime * 1000.0, NumIsLessThanCalls, KeyTime * 1000.0, NumGetSortKeyCalls));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancSortByPropertyMixedClassTest, "RancUtilities.Sorting.SortByPropertyMixedClasses", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancSortByPropertyMixedClassTest::RunTest(const FString& Parameters)
+{
+	URancTestNamedLevelObject* NamedB = NewObject<URancTestNamedLevelObject>(GetTransientPackage());
+	URancTestNamedLevelObject* NamedA = NewObject<URancTestNamedLevelObject>(GetTransientPackage());
+	NamedB->Level = TEXT("b");
+	NamedA->Level = TEXT("a");
+	URancTestLevelObject* Level3Rank1 = MakeLevelObject(3, 1.f);
+	URancTestLevelObject* Level1Rank2 = MakeLevelObject(1, 2.f);
+	URancTestLevelObject* Level3Rank4 = MakeLevelObject(3, 4.f);
+	URancTestLevelObject* Level1Rank2Tie = MakeLevelObject(1, 2.f);
+	URancTestLevelObject* Level2RankMinus1 = MakeLevelObject(2, -1.f);
+
+	// The rejected class comes first and has a string Level, it must not fix the Level column to strings
+	TArray<UObject*> Objects = {NamedB, Level3Rank1, Level1Rank2, NamedA, Level3Rank4, Level1Rank2Tie, Level2RankMinus1};
+	TArray<FRancSortProperty> SortProperties;
+	SortProperties.AddDefaulted(2);
+	SortProperties[0].PropertyName = TEXT("Level");
+	SortProperties[1].PropertyName = TEXT("Rank");
+	SortProperties[1].bDescending = true;
+	URancSortingLibrary::SortByProperties(Objects, SortProperties);
+	const TArray<UObject*> Expected = {Level1Rank2, Level1Rank2Tie, Level2RankMinus1, Level3Rank4, Level3Rank1, NamedB, NamedA};
+	TestTrue(TEXT("SortByProperties skips the rejected class"), Objects == Expected);
+
+	// A single numeric key takes the radix path, descending ties keep their order as well
+	UObject* WithoutLevel = NewObject<URancTestWeightedItem>(GetTransientPackage());
+	TArray<UObject*> LevelObjects = {WithoutLevel, Level3Rank1, Level1Rank2, Level3Rank4, Level1Rank2Tie, Level2RankMinus1};
+	URancSortingLibrary::SortByProperty(LevelObjects, TEXT("Level"), true);
+	const TArray<UObject*> ExpectedLevels = {Level3Rank1, Level3Rank4, Level2RankMinus1, Level1Rank2, Level1Rank2Tie, WithoutLevel};
+	TestTrue(TEXT("SortByProperty descending"), LevelObjects == ExpectedLevels);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancRadixSortPerfTest, "RancUtilities.Sorting.RadixSortPerformance", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRancRadixSortPerfTest::RunTest(const FString& Parameters)
+{
+	// One scratch for every size, as the library nodes reuse theirs across calls
+	FRancRadixSortScratch Scratch;
+	for (const int32 Num : {1000, 10000, 100000, 1000000})
+	{
+		const FRandomStream Stream(Num);
+		TArray<TPair<float, int32>> FloatPairs;
+		TArray<TPair<int64, int32>> IntPairs;
+		FloatPairs.Reserve(Num);
+		IntPairs.Reserve(Num);
+		for (int32 i = 0; i < Num; ++i)
+		{
+			FloatPairs.Emplace(Stream.FRandRange(-10000.f, 10000.f), i);
+			IntPairs.Emplace(static_cast<int64>(Stream.RandRange(-1000000000, 1000000000)) * 4096, i);
+		}
+
+		TArray<float> FloatKeys;
+		TArray<int64> IntKeys;
+		TArray<int32> Payloads;
+		for (int32 i = 0; i < Num; ++i)
+		{
+			FloatKeys.Add(FloatPairs[i].Key);
+			IntKeys.Add(IntPairs[i].Key);
+			Payloads.Add(i);
+		}
+		TArray<int32> IntPayloads = Payloads;
+
+		double StartTime = FPlatformTime::Seconds();
+		FloatPairs.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+		const double FloatSortTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		RancRadixSort::SortPairs(MakeArrayView(FloatKeys), MakeArrayView(Payloads), Scratch);
+		const double FloatRadixTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		IntPairs.Sort([](const TPair<int64, int32>& A, const TPair<int64, int32>& B) { return A.Key < B.Key; });
+		const double IntSortTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		RancRadixSort::SortPairs(MakeArrayView(IntKeys), MakeArrayView(IntPayloads), Scratch);
+		const double IntRadixTime = FPlatformTime::Seconds() - StartTime;
+
+		bool bSameKeys = true;
+		for (int32 i = 0; i < Num; ++i)
+		{
+			bSameKeys &= FloatKeys[i] == FloatPairs[i].Key && IntKeys[i] == IntPairs[i].Key;
+		}
+		TestTrue(FString::Printf(TEXT("%d keys: radix and TArray::Sort agree"), Num), bSameKeys);
+		AddInfo(FString::Printf(TEXT("%d pairs: float keys TArray::Sort %.2f ms, radix %.2f ms. int64 keys TArray::Sort %.2f ms, radix %.2f ms"),
+			Num, FloatSortTime * 1000.0, FloatRadixTime * 1000.0, IntSortTime * 1000.0, IntRadixTime * 1000.0));
+	}
+	return true;
+}
+
+#endif
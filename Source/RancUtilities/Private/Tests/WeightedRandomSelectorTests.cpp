@@ -0,0 +1,585 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "Algo/AllOf.h"
+#include "DynamicWeightedSampler.h"
+#include "Misc/AutomationTest.h"
+#include "RancTestObjects.h"
+#include "RancWeightKernels.h"
+#include "UObject/Package.h"
+#include "WeightedAliasTable.h"
+#include "WeightedItemCache.h"
+#include "WeightedRandomSelector.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Closed form probability of rolling Total with DiceCount dice of FaceCount faces numbered 1..FaceCount, by inclusion-exclusion
+	double GetExactDiceProbability(int32 DiceCount, int32 FaceCount, int32 Total)
+	{
+		const auto Choose = [](int32 N, int32 K)
+		{
+			if (K < 0 || N < K)
+			{
+				return 0.0;
+			}
+			double Result = 1.0;
+			for (int32 i = 1; i <= K; ++i)
+			{
+				Result = Result * (N - K + i) / i;
+			}
+			return Result;
+		};
+
+		double Ways = 0.0;
+		for (int32 k = 0; k <= DiceCount && Total - FaceCount * k >= DiceCount; ++k)
+		{
+			const double Term = Choose(DiceCount, k) * Choose(Total - FaceCount * k - 1, DiceCount - 1);
+			Ways += (k % 2 == 0) ? Term : -Term;
+		}
+		return Ways / FMath::Pow(static_cast<double>(FaceCount), DiceCount);
+	}
+
+	// Pearson's chi-square statistic of Results against the exact distribution of the pool
+	double GetDiceChiSquare(const TArray<int32>& Results, int32 DiceCount, int32 FaceCount)
+	{
+		TArray<int32> Counts;
+		Counts.SetNumZeroed(DiceCount * (FaceCount - 1) + 1);
+		for (const int32 Result : Results)
+		{
+			++Counts[Result - DiceCount];
+		}
+
+		double ChiSquare = 0.0;
+		for (int32 i = 0; i < Counts.Num(); ++i)
+		{
+			const double Expected = Results.Num() * GetExactDiceProbability(DiceCount, FaceCount, DiceCount + i);
+			ChiSquare += FMath::Square(Counts[i] - Expected) / Expected;
+		}
+		return ChiSquare;
+	}
+
+	// Pearson's chi-square statistic of Counts against Weights, outcomes of weight 0 must not have been drawn at all
+	double GetWeightsChiSquare(TConstArrayView<int32> Counts, TConstArrayView<double> Weights)
+	{
+		double TotalWeight = 0.0;
+		int64 NumDraws = 0;
+		for (int32 i = 0; i < Counts.Num(); ++i)
+		{
+			TotalWeight += Weights[i];
+			NumDraws += Counts[i];
+		}
+
+		double ChiSquare = 0.0;
+		for (int32 i = 0; i < Counts.Num(); ++i)
+		{
+			if (Weights[i] > 0.0)
+			{
+				const double Expected = NumDraws * Weights[i] / TotalWeight;
+				ChiSquare += FMath::Square(Counts[i] - Expected) / Expected;
+			}
+		}
+		return ChiSquare;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancDiceDistributionTest, "RancUtilities.WeightedRandomSelector.DiceDistribution", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancDiceDistributionTest::RunTest(const FString& Parameters)
+{
+	// 3d6 is rolled die by die, 5d6 comes from the cached alias table
+	for (const int32 DiceCount : {3, 5})
+	{
+		const TArray<float> Distribution = UWeightedRandomSelector::GetDiceDistribution(DiceCount, 6);
+		if (!TestEqual(FString::Printf(TEXT("%dd6 outcome count"), DiceCount), Distribution.Num(), DiceCount * 5 + 1))
+		{
+			continue;
+		}
+		for (int32 i = 0; i < Distribution.Num(); ++i)
+		{
+			TestEqual(FString::Printf(TEXT("%dd6 P(%d)"), DiceCount, DiceCount + i), Distribution[i],
+				static_cast<float>(GetExactDiceProbability(DiceCount, 6, DiceCount + i)), 1e-6f);
+		}
+	}
+	TestEqual(TEXT("3d6 P(10)"), UWeightedRandomSelector::GetDiceDistribution(3, 6)[7], 27.f / 216.f, 1e-6f);
+
+	// Critical values of chi-square at p = 0.001 for 15 and 25 degrees of freedom, the seed keeps the test deterministic
+	constexpr int32 NumRolls = 200000;
+	const FRandomStream Stream(12345);
+	const TArray<int32> Rolls3d6 = UWeightedRandomSelector::RollDiceManyFromStream(Stream, 3, 6, NumRolls);
+	const TArray<int32> Rolls5d6 = UWeightedRandomSelector::RollDiceManyFromStream(Stream, 5, 6, NumRolls);
+	TestEqual(TEXT("3d6 roll count"), Rolls3d6.Num(), NumRolls);
+	TestEqual(TEXT("5d6 roll count"), Rolls5d6.Num(), NumRolls);
+	TestTrue(TEXT("3d6 rolls are in range"), Algo::AllOf(Rolls3d6, [](int32 Roll) { return Roll >= 3 && Roll <= 18; }));
+	TestTrue(TEXT("5d6 rolls are in range"), Algo::AllOf(Rolls5d6, [](int32 Roll) { return Roll >= 5 && Roll <= 30; }));
+	if (!HasAnyErrors())
+	{
+		TestTrue(TEXT("3d6 chi-square"), GetDiceChiSquare(Rolls3d6, 3, 6) < 37.70);
+		TestTrue(TEXT("5d6 chi-square"), GetDiceChiSquare(Rolls5d6, 5, 6) < 52.62);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancWeightKernelsTest, "RancUtilities.WeightedRandomSelector.WeightKernels", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancWeightKernelsTest::RunTest(const FString& Parameters)
+{
+	// Not a multiple of the vector width, with a negative weight that counts as 0
+	const TArray<float> Weights = {1.f, 2.f, -4.f, 3.f, 0.5f, 0.f, 1.5f, 2.f, 1.f, 0.25f, 0.75f};
+	TArray<float> PrefixSums;
+	PrefixSums.SetNumUninitialized(Weights.Num());
+	const float Total = RancWeightKernels::PrefixSum(Weights, PrefixSums);
+
+	float Running = 0.f;
+	for (int32 i = 0; i < Weights.Num(); ++i)
+	{
+		Running += FMath::Max(Weights[i], 0.f);
+		TestEqual(FString::Printf(TEXT("PrefixSum[%d]"), i), PrefixSums[i], Running, 1e-5f);
+	}
+	TestEqual(TEXT("PrefixSum total"), Total, Running, 1e-5f);
+
+	// Weights 1, 2, 0, 3: the zero weight index is never the answer
+	const TArray<float> Sums = {1.f, 3.f, 3.f, 6.f};
+	TestEqual(TEXT("UpperBound(0)"), RancWeightKernels::UpperBound(Sums, 0.f), 0);
+	TestEqual(TEXT("UpperBound(0.99)"), RancWeightKernels::UpperBound(Sums, 0.99f), 0);
+	TestEqual(TEXT("UpperBound(1)"), RancWeightKernels::UpperBound(Sums, 1.f), 1);
+	TestEqual(TEXT("UpperBound(2.9)"), RancWeightKernels::UpperBound(Sums, 2.9f), 1);
+	TestEqual(TEXT("UpperBound(3)"), RancWeightKernels::UpperBound(Sums, 3.f), 3);
+	TestEqual(TEXT("UpperBound(5.99)"), RancWeightKernels::UpperBound(Sums, 5.99f), 3);
+	TestEqual(TEXT("UpperBound(6)"), RancWeightKernels::UpperBound(Sums, 6.f), 4);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancWeightedAliasTableTest, "RancUtilities.WeightedRandomSelector.AliasTableDistribution", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancWeightedAliasTableTest::RunTest(const FString& Parameters)
+{
+	// Zero and negative weights must never be drawn, the 8 positive ones give 7 degrees of freedom
+	const TArray<float> Weights = {1.f, 2.f, 0.f, 4.f, 0.5f, 3.f, -1.f, 8.f, 1.5f, 2.5f};
+	TArray<double> ExpectedWeights;
+	for (const float Weight : Weights)
+	{
+		ExpectedWeights.Add(FMath::Max(Weight, 0.f));
+	}
+
+	FWeightedAliasTable Table;
+	Table.Build(Weights);
+	TestEqual(TEXT("Table size"), Table.Num(), Weights.Num());
+
+	constexpr int32 NumDraws = 200000;
+	const FRandomStream Stream(2024);
+	TArray<int32> Indices;
+	Table.SampleMany(Stream, NumDraws, Indices);
+	if (!TestEqual(TEXT("Draw count"), Indices.Num(), NumDraws))
+	{
+		return true;
+	}
+
+	TArray<int32> Counts;
+	Counts.SetNumZeroed(Weights.Num());
+	for (const int32 Index : Indices)
+	{
+		if (!TestTrue(TEXT("Draws are valid indices"), Counts.IsValidIndex(Index)))
+		{
+			return true;
+		}
+		++Counts[Index];
+	}
+	TestEqual(TEXT("Weight 0 is never drawn"), Counts[2], 0);
+	TestEqual(TEXT("Negative weight is never drawn"), Counts[6], 0);
+	// Critical value of chi-square at p = 0.001 for 7 degrees of freedom
+	TestTrue(TEXT("Alias table chi-square"), GetWeightsChiSquare(Counts, ExpectedWeights) < 24.32);
+
+	// With every weight 0 the draw is uniform, critical value for 3 degrees of freedom
+	Table.Build({0.f, 0.f, -1.f, 0.f});
+	const FRandomStream UniformStream(2025);
+	TArray<int32> UniformCounts;
+	UniformCounts.SetNumZeroed(4);
+	for (int32 i = 0; i < 40000; ++i)
+	{
+		++UniformCounts[Table.Sample(UniformStream)];
+	}
+	TestTrue(TEXT("All weights 0 chi-square"), GetWeightsChiSquare(UniformCounts, {1.0, 1.0, 1.0, 1.0}) < 16.27);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancWeightedAliasTablePerfTest, "RancUtilities.WeightedRandomSelector.AliasTablePerformance", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRancWeightedAliasTablePerfTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumDraws = 50000;
+	for (const int32 NumWeights : {16, 1024, 16384})
+	{
+		const FRandomStream Stream(NumWeights);
+		TArray<float> Weights;
+		Weights.SetNumUninitialized(NumWeights);
+		for (float& Weight : Weights)
+		{
+			Weight = Stream.FRandRange(0.f, 10.f);
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		int64 IndexSum = 0;
+		for (int32 i = 0; i < NumDraws; ++i)
+		{
+			IndexSum += UWeightedRandomSelector::SelectRandomWeightedIndexFromStream(Stream, Weights);
+		}
+		const double LinearTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		FWeightedAliasTable Table;
+		Table.Build(Weights);
+		const double BuildTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		TArray<int32> Indices;
+		Table.SampleMany(Stream, NumDraws, Indices);
+		const double SampleTime = FPlatformTime::Seconds() - StartTime;
+
+		// Uses the results so the loops can't be optimized away
+		TestTrue(FString::Printf(TEXT("%d weights: draws are valid"), NumWeights), IndexSum >= 0 && Indices.Num() == NumDraws);
+		AddInfo(FString::Printf(TEXT("%d weights, %d draws: linear scan %.2f ms, alias table build %.2f ms + SampleMany %.2f ms"),
+			NumWeights, NumDraws, LinearTime * 1000.0, BuildTime * 1000.0, SampleTime * 1000.0));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancWeightedSumTreeTest, "RancUtilities.WeightedRandomSelector.SumTreeUpdates", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancWeightedSumTreeTest::RunTest(const FString& Parameters)
+{
+	const TArray<float> InitialWeights = {4.f, 1.f, 0.f, 2.f, 3.f, 5.f, 1.f, 2.f};
+	FWeightedSumTree Tree;
+	Tree.Build(InitialWeights);
+	TArray<double> ExpectedWeights;
+	for (const float Weight : InitialWeights)
+	{
+		ExpectedWeights.Add(Weight);
+	}
+
+	// Many small updates first, the sums must not drift from the leaves
+	const FRandomStream UpdateStream(7);
+	for (int32 i = 0; i < 1000; ++i)
+	{
+		const int32 Index = UpdateStream.RandRange(0, InitialWeights.Num() - 1);
+		const float Weight = UpdateStream.FRandRange(0.f, 10.f);
+		Tree.SetWeight(Index, Weight);
+		ExpectedWeights[Index] = Weight;
+	}
+
+	Tree.SetWeight(2, 0.f);
+	ExpectedWeights[2] = 0.0;
+	Tree.SetWeight(0, -3.f);
+	ExpectedWeights[0] = 0.0;
+	Tree.Remove(3);
+	TestEqual(TEXT("Add reuses the removed slot"), Tree.Add(7.f), 3);
+	ExpectedWeights[3] = 7.0;
+	// The ninth entry grows the tree past its first 8 leaves
+	TestEqual(TEXT("Add appends when no slot is free"), Tree.Add(2.5f), 8);
+	ExpectedWeights.Add(2.5);
+	Tree.Remove(6);
+	ExpectedWeights[6] = 0.0;
+
+	TestEqual(TEXT("Num"), Tree.Num(), 8);
+	TestFalse(TEXT("Removed index is not valid"), Tree.IsValidIndex(6));
+	double ExpectedTotal = 0.0;
+	for (int32 i = 0; i < ExpectedWeights.Num(); ++i)
+	{
+		TestEqual(FString::Printf(TEXT("GetWeight(%d)"), i), Tree.GetWeight(i), static_cast<float>(ExpectedWeights[i]), 1e-6f);
+		ExpectedTotal += ExpectedWeights[i];
+	}
+	TestEqual(TEXT("GetTotalWeight"), Tree.GetTotalWeight(), ExpectedTotal, 1e-9);
+
+	constexpr int32 NumDraws = 200000;
+	const FRandomStream Stream(2026);
+	TArray<int32> Counts;
+	Counts.SetNumZeroed(ExpectedWeights.Num());
+	for (int32 i = 0; i < NumDraws; ++i)
+	{
+		const int32 Index = Tree.Sample(Stream);
+		if (!TestTrue(TEXT("Draws are valid indices"), Counts.IsValidIndex(Index)))
+		{
+			return true;
+		}
+		++Counts[Index];
+	}
+	TestEqual(TEXT("Weight 0 is never drawn"), Counts[2], 0);
+	TestEqual(TEXT("Negative weight is never drawn"), Counts[0], 0);
+	TestEqual(TEXT("Removed entry is never drawn"), Counts[6], 0);
+	// Critical value of chi-square at p = 0.001 for the 6 positive weights, 5 degrees of freedom
+	TestTrue(TEXT("Sum tree chi-square"), GetWeightsChiSquare(Counts, ExpectedWeights) < 20.52);
+
+	// With every weight 0 the live entries are drawn uniformly, 8 live entries give 7 degrees of freedom
+	TArray<double> LiveWeights;
+	for (int32 i = 0; i < ExpectedWeights.Num(); ++i)
+	{
+		if (Tree.IsValidIndex(i))
+		{
+			Tree.SetWeight(i, 0.f);
+		}
+		LiveWeights.Add(Tree.IsValidIndex(i) ? 1.0 : 0.0);
+	}
+	const FRandomStream UniformStream(2027);
+	TArray<int32> UniformCounts;
+	UniformCounts.SetNumZeroed(ExpectedWeights.Num());
+	for (int32 i = 0; i < 40000; ++i)
+	{
+		++UniformCounts[Tree.Sample(UniformStream)];
+	}
+	TestEqual(TEXT("Removed entry is never drawn uniformly"), UniformCounts[6], 0);
+	TestTrue(TEXT("All weights 0 chi-square"), GetWeightsChiSquare(UniformCounts, LiveWeights) < 24.32);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancWeightedSumTreePerfTest, "RancUtilities.WeightedRandomSelector.SumTreePerformance", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRancWeightedSumTreePerfTest::RunTest(const FString& Parameters)
+{
+	// Every frame changes a few weights and draws a few times, like a spawn director
+	constexpr int32 NumFrames = 1000;
+	constexpr int32 UpdatesPerFrame = 16;
+	constexpr int32 DrawsPerFrame = 4;
+	for (const int32 NumWeights : {256, 4096, 65536})
+	{
+		const FRandomStream Stream(NumWeights);
+		TArray<float> Weights;
+		Weights.SetNumUninitialized(NumWeights);
+		for (float& Weight : Weights)
+		{
+			Weight = Stream.FRandRange(0.f, 10.f);
+		}
+
+		FWeightedSumTree Tree;
+		Tree.Build(Weights);
+		int64 IndexSum = 0;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (int32 i = 0; i < UpdatesPerFrame; ++i)
+			{
+				const int32 Index = Stream.RandHelper(NumWeights);
+				Tree.SetWeight(Index, Stream.FRandRange(0.f, 10.f));
+			}
+			for (int32 i = 0; i < DrawsPerFrame; ++i)
+			{
+				IndexSum += Tree.Sample(Stream);
+			}
+		}
+		const double TreeTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (int32 i = 0; i < UpdatesPerFrame; ++i)
+			{
+				const int32 Index = Stream.RandHelper(NumWeights);
+				Weights[Index] = Stream.FRandRange(0.f, 10.f);
+			}
+			for (const int32 Index : UWeightedRandomSelector::SelectManyWeightedIndicesFromStream(Stream, Weights, DrawsPerFrame))
+			{
+				IndexSum += Index;
+			}
+		}
+		const double ScanTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		FWeightedAliasTable Table;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (int32 i = 0; i < UpdatesPerFrame; ++i)
+			{
+				const int32 Index = Stream.RandHelper(NumWeights);
+				Weights[Index] = Stream.FRandRange(0.f, 10.f);
+			}
+			Table.Build(Weights);
+			for (int32 i = 0; i < DrawsPerFrame; ++i)
+			{
+				IndexSum += Table.Sample(Stream);
+			}
+		}
+		const double RebuildTime = FPlatformTime::Seconds() - StartTime;
+
+		TestTrue(FString::Printf(TEXT("%d weights: draws are valid"), NumWeights), IndexSum >= 0);
+		AddInfo(FString::Printf(TEXT("%d weights, %d frames of %d updates and %d draws: sum tree %.2f ms, prefix sum per frame %.2f ms, alias table rebuild per frame %.2f ms"),
+			NumWeights, NumFrames, UpdatesPerFrame, DrawsPerFrame, TreeTime * 1000.0, ScanTime * 1000.0, RebuildTime * 1000.0));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancWeightedItemCacheTest, "RancUtilities.WeightedRandomSelector.ItemCacheDuplicates", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRancWeightedItemCacheTest::RunTest(const FString& Parameters)
+{
+	URancTestWeightedItem* ItemA = NewObject<URancTestWeightedItem>(GetTransientPackage());
+	URancTestWeightedItem* ItemB = NewObject<URancTestWeightedItem>(GetTransientPackage());
+	URancTestWeightedItem* ItemC = NewObject<URancTestWeightedItem>(GetTransientPackage());
+	ItemA->Weight = 1.f;
+	ItemB->Weight = 3.f;
+	ItemC->Weight = 0.f;
+
+	// A is listed three times, so it has the same odds as B
+	const TArray<TScriptInterface<IWeightedItem>> Items = {ItemA, ItemB, ItemA, ItemC, ItemA};
+	UWeightedItemCache* Cache = UWeightedItemCache::CreateWeightedItemCache(GetTransientPackage(), Items);
+	TestEqual(TEXT("Every entry of A is read once"), ItemA->NumGetWeightCalls, 3);
+	TestEqual(TEXT("B is read once"), ItemB->NumGetWeightCalls, 1);
+	TestEqual(TEXT("C is read once"), ItemC->NumGetWeightCalls, 1);
+
+	const FRandomStream Stream(2028);
+	for (int32 i = 0; i < 100; ++i)
+	{
+		Cache->SelectRandomItemFromStream(Stream);
+	}
+	TestEqual(TEXT("Selecting does not read weights"), ItemA->NumGetWeightCalls + ItemB->NumGetWeightCalls + ItemC->NumGetWeightCalls, 5);
+
+	// Invalidating A must refresh all three of its entries, otherwise the stale ones keep A drawable
+	ItemA->Weight = 0.f;
+	Cache->InvalidateItem(ItemA);
+	bool bOnlyB = true;
+	for (int32 i = 0; i < 200; ++i)
+	{
+		bOnlyB &= Cache->SelectRandomItemFromStream(Stream).GetObject() == ItemB;
+	}
+	TestTrue(TEXT("Only B has weight after A is invalidated"), bOnlyB);
+	TestEqual(TEXT("Invalidating A reads its three entries again"), ItemA->NumGetWeightCalls, 6);
+	TestEqual(TEXT("Invalidating A does not read B"), ItemB->NumGetWeightCalls, 1);
+
+	ItemA->Weight = 1.f;
+	ItemC->Weight = 2.f;
+	Cache->InvalidateItem(ItemA);
+	Cache->InvalidateItem(ItemC);
+
+	// A and B weigh 3 in total each and C weighs 2, critical value of chi-square at p = 0.001 for 2 degrees of freedom
+	const FRandomStream DistributionStream(2029);
+	TArray<int32> Counts;
+	Counts.SetNumZeroed(3);
+	const UObject* const Objects[] = {ItemA, ItemB, ItemC};
+	for (int32 i = 0; i < 40000; ++i)
+	{
+		const UObject* Selected = Cache->SelectRandomItemFromStream(DistributionStream).GetObject();
+		for (int32 k = 0; k < 3; ++k)
+		{
+			Counts[k] += Selected == Objects[k] ? 1 : 0;
+		}
+	}
+	TestEqual(TEXT("Every draw is one of the items"), Counts[0] + Counts[1] + Counts[2], 40000);
+	TestTrue(TEXT("Item cache chi-square"), GetWeightsChiSquare(Counts, {3.0, 3.0, 2.0}) < 13.82);
+
+	Cache->InvalidateAll();
+	Cache->SelectRandomItemFromStream(DistributionStream);
+	TestEqual(TEXT("InvalidateAll reads every entry once"), ItemA->NumGetWeightCalls + ItemB->NumGetWeightCalls + ItemC->NumGetWeightCalls, 5 + 3 + 2 + 5);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancWeightedItemCachePerfTest, "RancUtilities.WeightedRandomSelector.ItemCachePerformance", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRancWeightedItemCachePerfTest::RunTest(const FString& Parameters)
+{
+	// One weight changes between selections, as when a single item goes on cooldown
+	constexpr int32 NumSelections = 1000;
+	for (const int32 NumItems : {16, 256, 4096})
+	{
+		const FRandomStream Stream(NumItems);
+		TArray<TScriptInterface<IWeightedItem>> Items;
+		TArray<URancTestWeightedItem*> WeightedItems;
+		for (int32 i = 0; i < NumItems; ++i)
+		{
+			URancTestWeightedItem* Item = NewObject<URancTestWeightedItem>(GetTransientPackage());
+			Item->Weight = Stream.FRandRange(0.f, 10.f);
+			WeightedItems.Add(Item);
+			Items.Add(Item);
+		}
+		const auto CountCalls = [&WeightedItems]()
+		{
+			int64 NumCalls = 0;
+			for (URancTestWeightedItem* Item : WeightedItems)
+			{
+				NumCalls += Item->NumGetWeightCalls;
+				Item->NumGetWeightCalls = 0;
+			}
+			return NumCalls;
+		};
+
+		int32 NumSelected = 0;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumSelections; ++i)
+		{
+			WeightedItems[Stream.RandHelper(NumItems)]->Weight = Stream.FRandRange(0.f, 10.f);
+			NumSelected += UWeightedRandomSelector::SelectRandomIWeightedItemFromStream(Stream, Items) ? 1 : 0;
+		}
+		const double DirectTime = FPlatformTime::Seconds() - StartTime;
+		const int64 DirectCalls = CountCalls();
+
+		StartTime = FPlatformTime::Seconds();
+		UWeightedItemCache* Cache = UWeightedItemCache::CreateWeightedItemCache(GetTransientPackage(), Items);
+		for (int32 i = 0; i < NumSelections; ++i)
+		{
+			URancTestWeightedItem* Item = WeightedItems[Stream.RandHelper(NumItems)];
+			Item->Weight = Stream.FRandRange(0.f, 10.f);
+			Cache->InvalidateItem(Item);
+			NumSelected += Cache->SelectRandomItemFromStream(Stream) ? 1 : 0;
+		}
+		const double CacheTime = FPlatformTime::Seconds() - StartTime;
+		const int64 CacheCalls = CountCalls();
+
+		TestEqual(FString::Printf(TEXT("%d items: every selection returns an item"), NumItems), NumSelected, 2 * NumSelections);
+		AddInfo(FString::Printf(TEXT("%d items, %d selections: SelectRandomIWeightedItem %.2f ms (%lld GetWeight calls), item cache %.2f ms (%lld GetWeight calls)"),
+			NumItems, NumSelections, DirectTime * 1000.0, DirectCalls, CacheTime * 1000.0, CacheCalls));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRancSelectManyWeightedPerfTest, "RancUtilities.WeightedRandomSelector.SelectManyPerformance", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRancSelectManyWeightedPerfTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumDraws = 1000;
+	for (const int32 NumWeights : {1 << 10, 1 << 16, 1 << 20})
+	{
+		const FRandomStream Stream(NumWeights);
+		TArray<float> Weights;
+		Weights.SetNumUninitialized(NumWeights);
+		for (float& Weight : Weights)
+		{
+			Weight = Stream.FRandRange(0.f, 10.f);
+		}
+
+		// The scalar cumulative loop against the vector kernel
+		TArray<float> PrefixSums;
+		PrefixSums.SetNumUninitialized(NumWeights);
+		double StartTime = FPlatformTime::Seconds();
+		float Running = 0.f;
+		for (int32 i = 0; i < NumWeights; ++i)
+		{
+			Running += FMath::Max(Weights[i], 0.f);
+			PrefixSums[i] = Running;
+		}
+		const double ScalarPrefixTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		const float Total = RancWeightKernels::PrefixSum(Weights, PrefixSums);
+		const double KernelPrefixTime = FPlatformTime::Seconds() - StartTime;
+		TestEqual(FString::Printf(TEXT("%d weights: kernel total"), NumWeights), Total, Running, Running * 1e-4f);
+
+		int64 IndexSum = 0;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumDraws; ++i)
+		{
+			IndexSum += UWeightedRandomSelector::SelectRandomWeightedIndexFromStream(Stream, Weights);
+		}
+		const double SingleTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for (const int32 Index : UWeightedRandomSelector::SelectManyWeightedIndicesFromStream(Stream, Weights, NumDraws))
+		{
+			IndexSum += Index;
+		}
+		const double BatchTime = FPlatformTime::Seconds() - StartTime;
+
+		TestTrue(FString::Printf(TEXT("%d weights: draws are valid"), NumWeights), IndexSum >= 0);
+		AddInfo(FString::Printf(TEXT("%d weights: prefix sum scalar %.3f ms, kernel %.3f ms. %d draws: SelectRandomWeightedIndex %.2f ms, SelectManyWeightedIndices %.2f ms"),
+			NumWeights, ScalarPrefixTime * 1000.0, KernelPrefixTime * 1000.0, NumDraws, SingleTime * 1000.0, BatchTime * 1000.0));
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,201 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "WeightedAliasTable.h"
+
+void FWeightedAliasTable::Build(TConstArrayView<float> Weights)
+{
+	const int32 NumWeights = Weights.Num();
+	Probabilities.SetNumUninitialized(NumWeights);
+	Aliases.SetNumUninitialized(NumWeights);
+
+	double TotalWeight = 0.0;
+	for (const float Weight : Weights)
+	{
+		// Written so NaN counts as 0 as well
+		TotalWeight += Weight > 0.f ? Weight : 0.f;
+	}
+
+	if (TotalWeight <= 0.0)
+	{
+		// All weights are 0, every column keeps itself so the draw is uniform
+		for (int32 i = 0; i < NumWeights; ++i)
+		{
+			Probabilities[i] = 1.f;
+			Aliases[i] = i;
+		}
+		return;
+	}
+
+	// Scale so the average column holds exactly 1, then pair each underfull column with an overfull one
+	TArray<double> Scaled;
+	Scaled.SetNumUninitialized(NumWeights);
+	TArray<int32> Small;
+	TArray<int32> Large;
+	Small.Reserve(NumWeights);
+	Large.Reserve(NumWeights);
+	for (int32 i = 0; i < NumWeights; ++i)
+	{
+		Scaled[i] = (Weights[i] > 0.f ? Weights[i] : 0.0) * NumWeights / TotalWeight;
+		(Scaled[i] < 1.0 ? Small : Large).Add(i);
+	}
+
+	while (!Small.IsEmpty() && !Large.IsEmpty())
+	{
+		const int32 Less = Small.Pop(EAllowShrinking::No);
+		const int32 More = Large.Pop(EAllowShrinking::No);
+		Probabilities[Less] = static_cast<float>(Scaled[Less]);
+		Aliases[Less] = More;
+
+		Scaled[More] = (Scaled[More] + Scaled[Less]) - 1.0;
+		(Scaled[More] < 1.0 ? Small : Large).Add(More);
+	}
+
+	// Whatever is left is 1 up to rounding error
+	for (const int32 Index : Small)
+	{
+		Probabilities[Index] = 1.f;
+		Aliases[Index] = Index;
+	}
+	for (const int32 Index : Large)
+	{
+		Probabilities[Index] = 1.f;
+		Aliases[Index] = Index;
+	}
+}
+
+int32 FWeightedAliasTable::Sample() const
+{
+	FRancGlobalRandom Random;
+	return Sample(Random);
+}
+
+void FWeightedAliasTable::SampleMany(int32 Count, TArray<int32>& OutIndices) const
+{
+	FRancGlobalRandom Random;
+	SampleMany(Random, Count, OutIndices);
+}
+
+UWeightedAliasTable* UWeightedAliasTable::CreateWeightedAliasTable(UObject* Outer, const TArray<float>& Weights)
+{
+	UWeightedAliasTable* AliasTable = NewObject<UWeightedAliasTable>(Outer ? Outer : GetTransientPackage());
+	AliasTable->BuildFromWeights(Weights);
+	return AliasTable;
+}
+
+UWeightedAliasTable* UWeightedAliasTable::CreateWeightedAliasTableFromItems(UObject* Outer, const TArray<FSWeightedItem>& Items)
+{
+	UWeightedAliasTable* AliasTable = NewObject<UWeightedAliasTable>(Outer ? Outer : GetTransientPackage());
+	AliasTable->BuildFromItems(Items);
+	return AliasTable;
+}
+
+void UWeightedAliasTable::BuildFromWeights(const TArray<float>& Weights)
+{
+	Items.Reset();
+	Table.Build(Weights);
+}
+
+void UWeightedAliasTable::BuildFromItems(const TArray<FSWeightedItem>& InItems)
+{
+	TArray<float> Weights;
+	Weights.Reserve(InItems.Num());
+	Items.Reset(InItems.Num());
+	for (const FSWeightedItem& Item : InItems)
+	{
+		Weights.Add(Item.Weight);
+		Items.Add(Item.Item);
+	}
+	Table.Build(Weights);
+}
+
+template <typename RandomType>
+UObject* UWeightedAliasTable::SampleItemWith(RandomType& Random) const
+{
+	const int32 Index = Table.Sample(Random);
+	return Items.IsValidIndex(Index) ? Items[Index] : nullptr;
+}
+
+template <typename RandomType>
+TArray<UObject*> UWeightedAliasTable::SampleManyItemsWith(RandomType& Random, int32 Count) const
+{
+	TArray<UObject*> Result;
+	if (Items.IsEmpty() || Count <= 0)
+	{
+		return Result;
+	}
+
+	Result.Reserve(Count);
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Result.Add(Items[Table.Sample(Random)]);
+	}
+	return Result;
+}
+
+int UWeightedAliasTable::SampleIndex() const
+{
+	return Table.Sample();
+}
+
+int UWeightedAliasTable::SampleIndexFromStream(const FRandomStream& Stream) const
+{
+	return Table.Sample(Stream);
+}
+
+int UWeightedAliasTable::SampleIndex(FRancRandom& Random) const
+{
+	return Table.Sample(Random);
+}
+
+UObject* UWeightedAliasTable::SampleItem() const
+{
+	FRancGlobalRandom Random;
+	return SampleItemWith(Random);
+}
+
+UObject* UWeightedAliasTable::SampleItemFromStream(const FRandomStream& Stream) const
+{
+	return SampleItemWith(Stream);
+}
+
+UObject* UWeightedAliasTable::SampleItem(FRancRandom& Random) const
+{
+	return SampleItemWith(Random);
+}
+
+TArray<int> UWeightedAliasTable::SampleMany(int32 Count) const
+{
+	TArray<int> Indices;
+	Table.SampleMany(Count, Indices);
+	return Indices;
+}
+
+TArray<int> UWeightedAliasTable::SampleManyFromStream(const FRandomStream& Stream, int32 Count) const
+{
+	TArray<int> Indices;
+	Table.SampleMany(Stream, Count, Indices);
+	return Indices;
+}
+
+TArray<int> UWeightedAliasTable::SampleMany(FRancRandom& Random, int32 Count) const
+{
+	TArray<int> Indices;
+	Table.SampleMany(Random, Count, Indices);
+	return Indices;
+}
+
+TArray<UObject*> UWeightedAliasTable::SampleManyItems(int32 Count) const
+{
+	FRancGlobalRandom Random;
+	return SampleManyItemsWith(Random, Count);
+}
+
+TArray<UObject*> UWeightedAliasTable::SampleManyItemsFromStream(const FRandomStream& Stream, int32 Count) const
+{
+	return SampleManyItemsWith(Stream, Count);
+}
+
+TArray<UObject*> UWeightedAliasTable::SampleManyItems(FRancRandom& Random, int32 Count) const
+{
+	return SampleManyItemsWith(Random, Count);
+}
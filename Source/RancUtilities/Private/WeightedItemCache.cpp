@@ -0,0 +1,91 @@
+﻿// Copyright Rancorous Games, 2024
+
+#include "WeightedItemCache.h"
+
+UWeightedItemCache* UWeightedItemCache::CreateWeightedItemCache(UObject* Outer, const TArray<TScriptInterface<IWeightedItem>>& Items)
+{
+	UWeightedItemCache* Cache = NewObject<UWeightedItemCache>(Outer ? Outer : GetTransientPackage());
+	Cache->SetItems(Items);
+	return Cache;
+}
+
+void UWeightedItemCache::SetItems(const TArray<TScriptInterface<IWeightedItem>>& InItems)
+{
+	Items = InItems;
+	ItemIndices.Reset();
+	ItemIndices.Reserve(Items.Num());
+	StaleIndices.Reset();
+	StaleMask.Init(false, Items.Num());
+
+	TArray<float> ItemWeights;
+	ItemWeights.SetNumUninitialized(Items.Num());
+	for (int32 i = 0; i < Items.Num(); ++i)
+	{
+		// Invalid interfaces get no weight
+		ItemWeights[i] = Items[i] ? IWeightedItem::Execute_GetWeight(Items[i].GetObject()) : 0.f;
+		if (Items[i])
+		{
+			ItemIndices.Add(Items[i].GetObject(), i);
+		}
+	}
+	Weights.Build(ItemWeights);
+}
+
+void UWeightedItemCache::InvalidateItem(const TScriptInterface<IWeightedItem>& Item)
+{
+	TArray<int32, TInlineAllocator<4>> Indices;
+	ItemIndices.MultiFind(Item.GetObject(), Indices);
+	for (const int32 Index : Indices)
+	{
+		MarkStale(Index);
+	}
+}
+
+void UWeightedItemCache::InvalidateAll()
+{
+	for (int32 i = 0; i < Items.Num(); ++i)
+	{
+		MarkStale(i);
+	}
+}
+
+void UWeightedItemCache::MarkStale(int32 Index)
+{
+	if (!StaleMask[Index])
+	{
+		StaleMask[Index] = true;
+		StaleIndices.Add(Index);
+	}
+}
+
+TScriptInterface<IWeightedItem> UWeightedItemCache::SelectRandomItem()
+{
+	RefreshWeights();
+	const int32 Index = Weights.Sample();
+	return Items.IsValidIndex(Index) ? Items[Index] : nullptr;
+}
+
+TScriptInterface<IWeightedItem> UWeightedItemCache::SelectRandomItemFromStream(const FRandomStream& Stream)
+{
+	RefreshWeights();
+	const int32 Index = Weights.Sample(Stream);
+	return Items.IsValidIndex(Index) ? Items[Index] : nullptr;
+}
+
+TScriptInterface<IWeightedItem> UWeightedItemCache::SelectRandomItem(FRancRandom& Random)
+{
+	RefreshWeights();
+	const int32 Index = Weights.Sample(Random);
+	return Items.IsValidIndex(Index) ? Items[Index] : nullptr;
+}
+
+void UWeightedItemCache::RefreshWeights()
+{
+	for (const int32 Index : StaleIndices)
+	{
+		StaleMask[Index] = false;
+		const TScriptInterface<IWeightedItem>& Item = Items[Index];
+		Weights.SetWeight(Index, Item ? IWeightedItem::Execute_GetWeight(Item.GetObject()) : 0.f);
+	}
+	StaleIndices.Reset();
+}
@@ -1,158 +1,703 @@
 ﻿// Copyright Rancorous Games, 2024
 
 #include "WeightedRandomSelector.h"
+#include "RancRandom.h"
+#include "RancWeightKernels.h"
+#include "TPriorityQueue.h"
+#include "WeightedReservoir.h"
+#include "WeightedAliasTable.h"
+#include "Misc/ScopeRWLock.h"
+#include "EngineUtils.h"
+#include "Engine/Engine.h"
 
-UObject* UWeightedRandomSelector::SelectRandomWeightedItem(const TArray<FSWeightedItem>& Items)
+namespace
 {
-	float TotalWeight = 0.f;
-	for (const FSWeightedItem& Item : Items)
+	/**
+	 * A-Res: every item gets the key log(U) / Weight and the K largest keys win, popped largest first.
+	 * GetWeight(Index) returns an unset optional for items to skip.
+	 */
+	template <typename RandomType, typename WeightFuncType>
+	void SelectKIndicesWithoutReplacement(RandomType& Random, int32 NumItems, int32 K, WeightFuncType&& GetWeight, TArray<int32>& OutIndices)
 	{
-		TotalWeight += Item.Weight;
-	}
+		K = FMath::Min(K, NumItems);
+		if (K <= 0)
+		{
+			return;
+		}
 
-	if (TotalWeight <= 0.f)
-	{
-		if (Items.IsEmpty())
+		// Zero weight items rank below every positive weight key, in random order among themselves
+		constexpr double ZeroWeightKeyOffset = -1e300;
+
+		TMinMaxPriorityQueue<int32, double, TGreater<double>> Reservoir(K);
+		Reservoir.Reserve(K);
+		for (int32 i = 0; i < NumItems; ++i)
 		{
-			return nullptr;
+			const TOptional<float> Weight = GetWeight(i);
+			if (!Weight.IsSet())
+			{
+				continue;
+			}
+
+			const double LogU = FMath::Loge(FMath::Max(static_cast<double>(Random.FRand()), UE_DOUBLE_SMALL_NUMBER));
+			const double Key = Weight.GetValue() > 0.f ? LogU / Weight.GetValue() : ZeroWeightKeyOffset * (1.0 - LogU);
+			Reservoir.Push(i, Key);
+		}
+
+		OutIndices.Reserve(OutIndices.Num() + Reservoir.Num());
+		while (!Reservoir.IsEmpty())
+		{
+			OutIndices.Add(Reservoir.Pop());
 		}
-		// All weights are 0, return a random item with equal probability
-		return Items[FMath::RandRange(0, Items.Num() - 1)].Item;
 	}
 
-	const float RandomWeight = FMath::RandRange(0.f, TotalWeight);
-	float CurrentWeight = 0.f;
+	// The selectors below take the generator as a template so the global, FRandomStream and FRancRandom versions share one body
 
-	for (const FSWeightedItem& Item : Items)
+	template <typename RandomType>
+	TArray<UObject*> SelectKWeightedItems(RandomType& Random, const TArray<FSWeightedItem>& Items, int32 K)
 	{
-		CurrentWeight += Item.Weight;
-		if (CurrentWeight >= RandomWeight)
+		TArray<int32> Indices;
+		SelectKIndicesWithoutReplacement(Random, Items.Num(), K, [&Items](int32 Index)
 		{
-			return Item.Item;
+			return TOptional<float>(Items[Index].Weight);
+		}, Indices);
+
+		TArray<UObject*> Result;
+		Result.Reserve(Indices.Num());
+		for (const int32 Index : Indices)
+		{
+			Result.Add(Items[Index].Item);
 		}
+		return Result;
 	}
 
-	return nullptr; // Return null if no item is selected (e.g., if Items is empty)
-}
-
+	template <typename RandomType>
+	TArray<int32> SelectKWeightedIndices(RandomType& Random, TConstArrayView<float> Weights, int32 K)
+	{
+		TArray<int32> Indices;
+		SelectKIndicesWithoutReplacement(Random, Weights.Num(), K, [Weights](int32 Index)
+		{
+			return TOptional<float>(Weights[Index]);
+		}, Indices);
+		return Indices;
+	}
 
-TScriptInterface<IWeightedItem> UWeightedRandomSelector::SelectRandomIWeightedItem(
-	const TArray<TScriptInterface<IWeightedItem>>& Items)
-{
-	float TotalWeight = 0.f;
-	// First loop: calculate total weight, iterating by const reference
-	for (const TScriptInterface<IWeightedItem>& Item : Items)
+	template <typename RandomType>
+	TArray<TScriptInterface<IWeightedItem>> SelectKIWeightedItems(RandomType& Random, const TArray<TScriptInterface<IWeightedItem>>& Items, int32 K)
 	{
-		if (Item) // Check if the interface is valid
+		TArray<int32> Indices;
+		SelectKIndicesWithoutReplacement(Random, Items.Num(), K, [&Items](int32 Index)
 		{
-			TotalWeight += IWeightedItem::Execute_GetWeight(Item.GetObject());
+			return Items[Index] ? TOptional<float>(IWeightedItem::Execute_GetWeight(Items[Index].GetObject())) : TOptional<float>();
+		}, Indices);
+
+		TArray<TScriptInterface<IWeightedItem>> Result;
+		Result.Reserve(Indices.Num());
+		for (const int32 Index : Indices)
+		{
+			Result.Add(Items[Index]);
 		}
+		return Result;
 	}
 
-	// If total weight is 0, all items have an equal chance (or return null if empty)
-	if (TotalWeight <= 0.f)
+	template <typename RandomType>
+	AActor* SelectIWeightedActor(RandomType& Random, const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass)
 	{
-		if (Items.IsEmpty())
+		UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+		if (!World || !ActorClass)
 		{
 			return nullptr;
 		}
-		// Pick a random one with equal probability
-		return Items[FMath::RandRange(0, Items.Num() - 1)];
+
+		TWeightedReservoir<AActor*> Reservoir;
+		for (TActorIterator<AActor> It(World, ActorClass); It; ++It)
+		{
+			if (It->Implements<UWeightedItem>())
+			{
+				Reservoir.Add(Random, *It, IWeightedItem::Execute_GetWeight(*It));
+			}
+		}
+		return Reservoir.HasSelection() ? Reservoir.GetSelection() : nullptr;
 	}
 
-	const float RandomWeight = FMath::RandRange(0.f, TotalWeight);
-	float CurrentWeight = 0.f;
+	template <typename RandomType>
+	AActor* SelectWeightedActor(RandomType& Random, const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass,
+		const FGetActorWeightDelegate& GetWeight)
+	{
+		UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+		if (!World || !ActorClass || !GetWeight.IsBound())
+		{
+			return nullptr;
+		}
+
+		TWeightedReservoir<AActor*> Reservoir;
+		for (TActorIterator<AActor> It(World, ActorClass); It; ++It)
+		{
+			Reservoir.Add(Random, *It, GetWeight.Execute(*It));
+		}
+		return Reservoir.HasSelection() ? Reservoir.GetSelection() : nullptr;
+	}
 
-	// Second loop: find the selected item, iterating by const reference
-	for (const TScriptInterface<IWeightedItem>& Item : Items) // This is the fix for the compiler error
+	template <typename RandomType>
+	UObject* SelectWeightedItem(RandomType& Random, const TArray<FSWeightedItem>& Items)
 	{
-		if (Item)
+		float TotalWeight = 0.f;
+		for (const FSWeightedItem& Item : Items)
+		{
+			TotalWeight += Item.Weight;
+		}
+
+		if (TotalWeight <= 0.f)
+		{
+			if (Items.IsEmpty())
+			{
+				return nullptr;
+			}
+			// All weights are 0, return a random item with equal probability
+			return Items[Random.RandRange(0, Items.Num() - 1)].Item;
+		}
+
+		const float RandomWeight = Random.FRandRange(0.f, TotalWeight);
+		float CurrentWeight = 0.f;
+
+		for (const FSWeightedItem& Item : Items)
 		{
-			CurrentWeight += IWeightedItem::Execute_GetWeight(Item.GetObject());
+			CurrentWeight += Item.Weight;
 			if (CurrentWeight >= RandomWeight)
 			{
-				return Item;
+				return Item.Item;
 			}
 		}
-	}
 
-	return nullptr;
-}
+		return nullptr; // Return null if no item is selected (e.g., if Items is empty)
+	}
 
-int UWeightedRandomSelector::SelectRandomItemIndex(const TArray<UObject*>& Items, const FGetWeightDelegate& GetWeight)
-{
-	float TotalWeight = 0.f;
-	for (int32 i = 0; i < Items.Num(); ++i)
+	template <typename RandomType>
+	TScriptInterface<IWeightedItem> SelectIWeightedItem(RandomType& Random, const TArray<TScriptInterface<IWeightedItem>>& Items)
 	{
-		TotalWeight += GetWeight.Execute(i);
+		// Gather each weight once, GetWeight may be a Blueprint event and is too expensive to call twice per item
+		TArray<float, TInlineAllocator<64>> Weights;
+		Weights.SetNumUninitialized(Items.Num());
+		float TotalWeight = 0.f;
+		for (int32 i = 0; i < Items.Num(); ++i)
+		{
+			// Invalid interfaces get no weight
+			Weights[i] = Items[i] ? IWeightedItem::Execute_GetWeight(Items[i].GetObject()) : 0.f;
+			TotalWeight += Weights[i];
+		}
+
+		// If total weight is 0, all items have an equal chance (or return null if empty)
+		if (TotalWeight <= 0.f)
+		{
+			if (Items.IsEmpty())
+			{
+				return nullptr;
+			}
+			// Pick a random one with equal probability
+			return Items[Random.RandRange(0, Items.Num() - 1)];
+		}
+
+		const float RandomWeight = Random.FRandRange(0.f, TotalWeight);
+		float CurrentWeight = 0.f;
+
+		for (int32 i = 0; i < Items.Num(); ++i)
+		{
+			if (Items[i])
+			{
+				CurrentWeight += Weights[i];
+				if (CurrentWeight >= RandomWeight)
+				{
+					return Items[i];
+				}
+			}
+		}
+
+		return nullptr;
 	}
 
-	if (TotalWeight <= 0.f)
+	template <typename RandomType>
+	int32 SelectWeightedIndex(RandomType& Random, TConstArrayView<float> Weights)
 	{
-		if (Items.IsEmpty())
+		if (Weights.Num() == 0)
 		{
 			return INDEX_NONE;
 		}
-		return FMath::RandRange(0, Items.Num() - 1);
+
+		float TotalWeight = 0.f;
+		for (float Weight : Weights)
+		{
+			TotalWeight += Weight;
+		}
+
+		// If all weights are zero, pick one with uniform probability
+		if (TotalWeight <= 0.f)
+		{
+			return Random.RandRange(0, Weights.Num() - 1);
+		}
+
+		const float RandomWeight = Random.FRandRange(0.f, TotalWeight);
+		float CurrentWeight = 0.f;
+
+		for (int32 i = 0; i < Weights.Num(); ++i)
+		{
+			CurrentWeight += Weights[i];
+			if (CurrentWeight >= RandomWeight)
+			{
+				return i;
+			}
+		}
+
+		return INDEX_NONE;
 	}
 
-	const float RandomWeight = FMath::RandRange(0.f, TotalWeight);
-	float CurrentWeight = 0.f;
+	template <typename RandomType>
+	int32 SelectWeightedIndex(RandomType& Random, int32 ItemCount, TFunctionRef<float(int32)> GetWeight)
+	{
+		if (ItemCount <= 0)
+		{
+			return INDEX_NONE;
+		}
+
+		// Gather each weight once so the provider runs N times rather than up to 2N
+		TArray<float, TInlineAllocator<64>> Weights;
+		Weights.SetNumUninitialized(ItemCount);
+		for (int32 i = 0; i < ItemCount; ++i)
+		{
+			Weights[i] = GetWeight(i);
+		}
+		return SelectWeightedIndex(Random, Weights);
+	}
 
-	for (int32 i = 0; i < Items.Num(); ++i)
+	template <typename RandomType>
+	void SelectManyWeighted(RandomType& Random, TConstArrayView<float> Weights, int32 Count, TArray<int32>& OutIndices)
 	{
-		CurrentWeight += GetWeight.Execute(i);
-		if (CurrentWeight >= RandomWeight)
+		if (Weights.IsEmpty() || Count <= 0)
 		{
-			return i;
+			return;
+		}
+
+		OutIndices.Reserve(OutIndices.Num() + Count);
+		TArray<float> PrefixSums;
+		PrefixSums.SetNumUninitialized(Weights.Num());
+		const float TotalWeight = RancWeightKernels::PrefixSum(Weights, PrefixSums);
+
+		// If all weights are zero, pick with uniform probability
+		if (TotalWeight <= 0.f)
+		{
+			for (int32 i = 0; i < Count; ++i)
+			{
+				OutIndices.Add(Random.RandRange(0, Weights.Num() - 1));
+			}
+			return;
+		}
+
+		// A draw of exactly the total would run past the end, it belongs to the last positive weight
+		int32 LastPositive = Weights.Num() - 1;
+		while (LastPositive > 0 && PrefixSums[LastPositive - 1] >= TotalWeight)
+		{
+			--LastPositive;
+		}
+
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const int32 Index = RancWeightKernels::UpperBound(PrefixSums, Random.FRand() * TotalWeight);
+			OutIndices.Add(FMath::Min(Index, LastPositive));
 		}
 	}
 
-	return INDEX_NONE;
-}
+	// Pools with fewer dice are cheaper to roll one die at a time than to look up
+	constexpr int32 MinCachedDiceCount = 5;
+	// Caps the size and the one-off convolution work of a cached distribution
+	constexpr int32 MaxCachedDiceOutcomes = 1 << 16;
+	constexpr int64 MaxCachedDiceWork = int64(1) << 26;
 
-int UWeightedRandomSelector::SelectRandomWeightedIndex(const TArray<float>& Weights)
-{
-	if (Weights.Num() == 0)
+	int32 GetDiceFaceCount(int32 DiceSides, bool bDiceHas0)
+	{
+		return bDiceHas0 ? DiceSides + 1 : DiceSides;
+	}
+
+	// Probability of every total of the pool by repeated convolution with one die, using a sliding window sum
+	TArray<double> ConvolveDice(int32 DiceCount, int32 FaceCount)
 	{
-		return INDEX_NONE; 
+		TArray<double> Distribution = { 1.0 };
+		TArray<double> Next;
+		const double FaceProbability = 1.0 / FaceCount;
+		for (int32 Die = 0; Die < DiceCount; ++Die)
+		{
+			Next.SetNumUninitialized(Distribution.Num() + FaceCount - 1);
+			double Window = 0.0;
+			for (int32 Total = 0; Total < Next.Num(); ++Total)
+			{
+				if (Total < Distribution.Num())
+				{
+					Window += Distribution[Total];
+				}
+				if (Total >= FaceCount)
+				{
+					Window -= Distribution[Total - FaceCount];
+				}
+				// The running subtraction can leave tiny negative residue in the tails
+				Next[Total] = FMath::Max(Window, 0.0) * FaceProbability;
+			}
+			Swap(Distribution, Next);
+		}
+		return Distribution;
 	}
-	
-	float TotalWeight = 0.f;
-	for (float Weight : Weights)
+
+	using FDiceTablePtr = TSharedPtr<const FWeightedAliasTable, ESPMode::ThreadSafe>;
+
+	FRWLock DiceTablesLock;
+	TMap<uint64, FDiceTablePtr> DiceTables;
+
+	// Alias table over the totals of the pool, offset by the lowest total. Null for pools rolled die by die.
+	FDiceTablePtr FindOrBuildDiceTable(int32 DiceCount, int32 DiceSides, bool bDiceHas0)
 	{
-		TotalWeight += Weight;
+		const int32 FaceCount = GetDiceFaceCount(DiceSides, bDiceHas0);
+		if (DiceCount < MinCachedDiceCount || FaceCount < 2)
+		{
+			return nullptr;
+		}
+
+		const int64 NumOutcomes = int64(DiceCount) * (FaceCount - 1) + 1;
+		if (NumOutcomes > MaxCachedDiceOutcomes || NumOutcomes * DiceCount > MaxCachedDiceWork)
+		{
+			return nullptr;
+		}
+
+		const uint64 Key = (uint64(uint32(DiceCount)) << 32) | (uint64(uint32(DiceSides)) << 1) | (bDiceHas0 ? 1 : 0);
+		{
+			FReadScopeLock ReadLock(DiceTablesLock);
+			if (const FDiceTablePtr* Table = DiceTables.Find(Key))
+			{
+				return *Table;
+			}
+		}
+
+		// Built outside the lock, if two threads race the first one to publish wins
+		const TArray<double> Distribution = ConvolveDice(DiceCount, FaceCount);
+		const double MaxProbability = Distribution[Distribution.Num() / 2];
+		TArray<float> Weights;
+		Weights.SetNumUninitialized(Distribution.Num());
+		for (int32 i = 0; i < Distribution.Num(); ++i)
+		{
+			// Relative to the most likely total so the float weights don't underflow for large pools
+			Weights[i] = static_cast<float>(Distribution[i] / MaxProbability);
+		}
+
+		TSharedRef<FWeightedAliasTable, ESPMode::ThreadSafe> NewTable = MakeShared<FWeightedAliasTable, ESPMode::ThreadSafe>();
+		NewTable->Build(Weights);
+
+		FWriteScopeLock WriteLock(DiceTablesLock);
+		return DiceTables.FindOrAdd(Key, NewTable);
 	}
 
-	// If all weights are zero, pick one with uniform probability
-	if (TotalWeight <= 0.f)
+	template <typename RandomType>
+	int32 RollDiceWith(RandomType& Random, int32 DiceCount, int32 DiceSides, bool bDiceHas0)
 	{
-		return FMath::RandRange(0, Weights.Num() - 1);
+		if (const FDiceTablePtr Table = FindOrBuildDiceTable(DiceCount, DiceSides, bDiceHas0))
+		{
+			return (bDiceHas0 ? 0 : DiceCount) + Table->Sample(Random);
+		}
+
+		// roll the dice
+		int32 DiceResult = 0;
+		for (int32 i = 0; i < DiceCount; ++i)
+		{
+			DiceResult += Random.RandRange(bDiceHas0 ? 0 : 1, DiceSides);
+		}
+
+		return DiceResult;
 	}
-	
-	const float RandomWeight = FMath::RandRange(0.f, TotalWeight);
-	float CurrentWeight = 0.f;
-	
-	for (int32 i = 0; i < Weights.Num(); ++i)
+
+	template <typename RandomType>
+	void RollDiceManyWith(RandomType& Random, int32 DiceCount, int32 DiceSides, int32 Count, bool bDiceHas0, TArray<int32>& OutResults)
 	{
-		CurrentWeight += Weights[i];
-		if (CurrentWeight >= RandomWeight)
+		if (Count <= 0)
+		{
+			return;
+		}
+
+		OutResults.Reserve(OutResults.Num() + Count);
+		// Look the table up once for the whole batch
+		if (const FDiceTablePtr Table = FindOrBuildDiceTable(DiceCount, DiceSides, bDiceHas0))
 		{
-			return i;
+			const int32 LowestTotal = bDiceHas0 ? 0 : DiceCount;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				OutResults.Add(LowestTotal + Table->Sample(Random));
+			}
+			return;
+		}
+
+		for (int32 i = 0; i < Count; ++i)
+		{
+			OutResults.Add(RollDiceWith(Random, DiceCount, DiceSides, bDiceHas0));
 		}
 	}
+}
+
+UObject* UWeightedRandomSelector::SelectRandomWeightedItem(const TArray<FSWeightedItem>& Items)
+{
+	FRancGlobalRandom Random;
+	return SelectWeightedItem(Random, Items);
+}
+
+UObject* UWeightedRandomSelector::SelectRandomWeightedItemFromStream(const FRandomStream& Stream, const TArray<FSWeightedItem>& Items)
+{
+	return SelectWeightedItem(Stream, Items);
+}
+
+UObject* UWeightedRandomSelector::SelectRandomWeightedItem(FRancRandom& Random, const TArray<FSWeightedItem>& Items)
+{
+	return SelectWeightedItem(Random, Items);
+}
+
+TScriptInterface<IWeightedItem> UWeightedRandomSelector::SelectRandomIWeightedItem(
+	const TArray<TScriptInterface<IWeightedItem>>& Items)
+{
+	FRancGlobalRandom Random;
+	return SelectIWeightedItem(Random, Items);
+}
+
+TScriptInterface<IWeightedItem> UWeightedRandomSelector::SelectRandomIWeightedItemFromStream(const FRandomStream& Stream,
+	const TArray<TScriptInterface<IWeightedItem>>& Items)
+{
+	return SelectIWeightedItem(Stream, Items);
+}
+
+TScriptInterface<IWeightedItem> UWeightedRandomSelector::SelectRandomIWeightedItem(FRancRandom& Random,
+	const TArray<TScriptInterface<IWeightedItem>>& Items)
+{
+	return SelectIWeightedItem(Random, Items);
+}
+
+int UWeightedRandomSelector::SelectRandomItemIndex(const TArray<UObject*>& Items, const FGetWeightDelegate& GetWeight)
+{
+	return SelectRandomItemIndex(Items.Num(), [&GetWeight](int32 ItemIndex)
+	{
+		return GetWeight.Execute(ItemIndex);
+	});
+}
+
+int UWeightedRandomSelector::SelectRandomItemIndexFromStream(const FRandomStream& Stream, const TArray<UObject*>& Items,
+	const FGetWeightDelegate& GetWeight)
+{
+	return SelectWeightedIndex(Stream, Items.Num(), [&GetWeight](int32 ItemIndex)
+	{
+		return GetWeight.Execute(ItemIndex);
+	});
+}
+
+int UWeightedRandomSelector::SelectRandomItemIndexBatched(const TArray<UObject*>& Items, const FGetWeightsDelegate& GetWeights)
+{
+	if (Items.IsEmpty())
+	{
+		return INDEX_NONE;
+	}
+
+	const TArray<float> Weights = GetWeights.Execute(Items.Num());
+	if (Weights.Num() != Items.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SelectRandomItemIndexBatched: GetWeights returned %d weights for %d items."), Weights.Num(), Items.Num());
+		return INDEX_NONE;
+	}
+	return SelectRandomWeightedIndex(Weights);
+}
+
+int UWeightedRandomSelector::SelectRandomItemIndex(int32 ItemCount, TFunctionRef<float(int32)> GetWeight)
+{
+	FRancGlobalRandom Random;
+	return SelectWeightedIndex(Random, ItemCount, GetWeight);
+}
+
+int UWeightedRandomSelector::SelectRandomItemIndex(FRancRandom& Random, int32 ItemCount, TFunctionRef<float(int32)> GetWeight)
+{
+	return SelectWeightedIndex(Random, ItemCount, GetWeight);
+}
+
+int UWeightedRandomSelector::SelectRandomWeightedIndex(const TArray<float>& Weights)
+{
+	FRancGlobalRandom Random;
+	return SelectWeightedIndex(Random, Weights);
+}
+
+int UWeightedRandomSelector::SelectRandomWeightedIndexFromStream(const FRandomStream& Stream, const TArray<float>& Weights)
+{
+	return SelectWeightedIndex(Stream, Weights);
+}
+
+int UWeightedRandomSelector::SelectRandomWeightedIndex(TConstArrayView<float> Weights)
+{
+	FRancGlobalRandom Random;
+	return SelectWeightedIndex(Random, Weights);
+}
+
+int UWeightedRandomSelector::SelectRandomWeightedIndex(FRancRandom& Random, TConstArrayView<float> Weights)
+{
+	return SelectWeightedIndex(Random, Weights);
+}
+
+TArray<int> UWeightedRandomSelector::SelectManyWeightedIndices(const TArray<float>& Weights, int Count)
+{
+	FRancGlobalRandom Random;
+	TArray<int32> Indices;
+	SelectManyWeighted(Random, Weights, Count, Indices);
+	return Indices;
+}
+
+TArray<int> UWeightedRandomSelector::SelectManyWeightedIndicesFromStream(const FRandomStream& Stream, const TArray<float>& Weights, int Count)
+{
+	TArray<int32> Indices;
+	SelectManyWeighted(Stream, Weights, Count, Indices);
+	return Indices;
+}
+
+void UWeightedRandomSelector::SelectManyWeightedIndices(FRancRandom& Random, TConstArrayView<float> Weights, int32 Count, TArray<int32>& OutIndices)
+{
+	SelectManyWeighted(Random, Weights, Count, OutIndices);
+}
+
+TArray<UObject*> UWeightedRandomSelector::SelectKWeightedWithoutReplacement(const TArray<FSWeightedItem>& Items, int K)
+{
+	FRancGlobalRandom Random;
+	return SelectKWeightedItems(Random, Items, K);
+}
+
+TArray<UObject*> UWeightedRandomSelector::SelectKWeightedWithoutReplacementFromStream(const FRandomStream& Stream, const TArray<FSWeightedItem>& Items, int K)
+{
+	return SelectKWeightedItems(Stream, Items, K);
+}
+
+TArray<UObject*> UWeightedRandomSelector::SelectKWeightedWithoutReplacement(FRancRandom& Random, const TArray<FSWeightedItem>& Items, int K)
+{
+	return SelectKWeightedItems(Random, Items, K);
+}
+
+TArray<int> UWeightedRandomSelector::SelectKWeightedIndicesWithoutReplacement(const TArray<float>& Weights, int K)
+{
+	FRancGlobalRandom Random;
+	return SelectKWeightedIndices(Random, Weights, K);
+}
+
+TArray<int> UWeightedRandomSelector::SelectKWeightedIndicesWithoutReplacementFromStream(const FRandomStream& Stream, const TArray<float>& Weights, int K)
+{
+	return SelectKWeightedIndices(Stream, Weights, K);
+}
+
+TArray<int> UWeightedRandomSelector::SelectKWeightedIndicesWithoutReplacement(FRancRandom& Random, TConstArrayView<float> Weights, int K)
+{
+	return SelectKWeightedIndices(Random, Weights, K);
+}
+
+TArray<TScriptInterface<IWeightedItem>> UWeightedRandomSelector::SelectKIWeightedItemsWithoutReplacement(
+	const TArray<TScriptInterface<IWeightedItem>>& Items, int K)
+{
+	FRancGlobalRandom Random;
+	return SelectKIWeightedItems(Random, Items, K);
+}
+
+TArray<TScriptInterface<IWeightedItem>> UWeightedRandomSelector::SelectKIWeightedItemsWithoutReplacementFromStream(const FRandomStream& Stream,
+	const TArray<TScriptInterface<IWeightedItem>>& Items, int K)
+{
+	return SelectKIWeightedItems(Stream, Items, K);
+}
+
+TArray<TScriptInterface<IWeightedItem>> UWeightedRandomSelector::SelectKIWeightedItemsWithoutReplacement(FRancRandom& Random,
+	const TArray<TScriptInterface<IWeightedItem>>& Items, int K)
+{
+	return SelectKIWeightedItems(Random, Items, K);
+}
+
+AActor* UWeightedRandomSelector::SelectRandomIWeightedActor(const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass)
+{
+	FRancGlobalRandom Random;
+	return SelectIWeightedActor(Random, WorldContextObject, ActorClass);
+}
+
+AActor* UWeightedRandomSelector::SelectRandomIWeightedActorFromStream(const FRandomStream& Stream, const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass)
+{
+	return SelectIWeightedActor(Stream, WorldContextObject, ActorClass);
+}
+
+AActor* UWeightedRandomSelector::SelectRandomIWeightedActor(FRancRandom& Random, const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass)
+{
+	return SelectIWeightedActor(Random, WorldContextObject, ActorClass);
+}
+
+AActor* UWeightedRandomSelector::SelectRandomWeightedActor(const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass,
+	const FGetActorWeightDelegate& GetWeight)
+{
+	FRancGlobalRandom Random;
+	return SelectWeightedActor(Random, WorldContextObject, ActorClass, GetWeight);
+}
+
+AActor* UWeightedRandomSelector::SelectRandomWeightedActorFromStream(const FRandomStream& Stream, const UObject* WorldContextObject,
+	TSubclassOf<AActor> ActorClass, const FGetActorWeightDelegate& GetWeight)
+{
+	return SelectWeightedActor(Stream, WorldContextObject, ActorClass, GetWeight);
+}
 
-	return INDEX_NONE;
+AActor* UWeightedRandomSelector::SelectRandomWeightedActor(FRancRandom& Random, const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass,
+	const FGetActorWeightDelegate& GetWeight)
+{
+	return SelectWeightedActor(Random, WorldContextObject, ActorClass, GetWeight);
 }
 
 int UWeightedRandomSelector::RollDice(int DiceCount, int DiceSides, bool bDiceHas0)
 {
-	// roll the dice
-	int32 DiceResult = 0;
-	for (int32 i = 0; i < DiceCount; ++i)
+	FRancGlobalRandom Random;
+	return RollDiceWith(Random, DiceCount, DiceSides, bDiceHas0);
+}
+
+int UWeightedRandomSelector::RollDiceFromStream(const FRandomStream& Stream, int DiceCount, int DiceSides, bool bDiceHas0)
+{
+	return RollDiceWith(Stream, DiceCount, DiceSides, bDiceHas0);
+}
+
+int UWeightedRandomSelector::RollDice(FRancRandom& Random, int DiceCount, int DiceSides, bool bDiceHas0)
+{
+	return RollDiceWith(Random, DiceCount, DiceSides, bDiceHas0);
+}
+
+TArray<int> UWeightedRandomSelector::RollDiceMany(int DiceCount, int DiceSides, int Count, bool bDiceHas0)
+{
+	FRancGlobalRandom Random;
+	TArray<int32> Results;
+	RollDiceManyWith(Random, DiceCount, DiceSides, Count, bDiceHas0, Results);
+	return Results;
+}
+
+TArray<int> UWeightedRandomSelector::RollDiceManyFromStream(const FRandomStream& Stream, int DiceCount, int DiceSides, int Count, bool bDiceHas0)
+{
+	TArray<int32> Results;
+	RollDiceManyWith(Stream, DiceCount, DiceSides, Count, bDiceHas0, Results);
+	return Results;
+}
+
+void UWeightedRandomSelector::RollDiceMany(FRancRandom& Random, int DiceCount, int DiceSides, int Count, TArray<int32>& OutResults, bool bDiceHas0)
+{
+	RollDiceManyWith(Random, DiceCount, DiceSides, Count, bDiceHas0, OutResults);
+}
+
+TArray<float> UWeightedRandomSelector::GetDiceDistribution(int DiceCount, int DiceSides, bool bDiceHas0)
+{
+	TArray<float> Probabilities;
+	const int32 FaceCount = GetDiceFaceCount(DiceSides, bDiceHas0);
+	if (DiceCount <= 0 || FaceCount < 1)
+	{
+		return Probabilities;
+	}
+
+	if (int64(DiceCount) * ((int64(DiceCount) * (FaceCount - 1)) + 1) > MaxCachedDiceWork)
 	{
-		DiceResult += FMath::RandRange(bDiceHas0 ? 0 : 1, DiceSides);
+		UE_LOG(LogTemp, Warning, TEXT("GetDiceDistribution: %dd%d is too large to compute."), DiceCount, DiceSides);
+		return Probabilities;
 	}
 
-	return DiceResult;
+	const TArray<double> Distribution = ConvolveDice(DiceCount, FaceCount);
+	Probabilities.Reserve(Distribution.Num());
+	for (const double Probability : Distribution)
+	{
+		Probabilities.Add(static_cast<float>(Probability));
+	}
+	return Probabilities;
 }
\ No newline at end of file
@@ -0,0 +1,133 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "RancRandom.h"
+#include "DynamicWeightedSampler.generated.h"
+
+/**
+ * FWeightedSumTree is a weighted index sampler whose weights can change between draws.
+ * Weights sit in the leaves of a complete binary tree where every node holds the sum of its children,
+ * so SetWeight, Add, Remove and Sample are all O(log n).
+ *
+ * Indices are stable: Remove frees the slot and a later Add may reuse it.
+ * Sums are recomputed from the children on every update rather than adjusted by deltas,
+ * so frequent small changes do not accumulate rounding drift.
+ * Like UWeightedRandomSelector, live entries are drawn uniformly while every weight is 0. Negative weights count as 0.
+ */
+struct RANCUTILITIES_API FWeightedSumTree
+{
+	// Replaces every entry with Weights in O(n), entry i gets index i
+	void Build(TConstArrayView<float> Weights);
+
+	void Reset();
+
+	// Adds an entry and returns its index
+	int32 Add(float Weight);
+
+	// Removes the entry at Index, its slot may be reused by a later Add
+	void Remove(int32 Index);
+
+	void SetWeight(int32 Index, float Weight);
+
+	float GetWeight(int32 Index) const;
+
+	bool IsValidIndex(int32 Index) const;
+
+	// Number of live entries
+	int32 Num() const { return NumLive(1); }
+
+	double GetTotalWeight() const { return Nodes.IsEmpty() ? 0.0 : Nodes[1].Weight; }
+
+	// Draws the index of a live entry, INDEX_NONE if there is none
+	int32 Sample() const;
+
+	// Draws from Random, for seeded or per-thread sampling
+	int32 Sample(FRancRandom& Random) const;
+
+	int32 Sample(const FRandomStream& Stream) const;
+
+private:
+	struct FNode
+	{
+		double Weight = 0.0;
+		int32 NumLive = 0;
+	};
+
+	template <typename RandomType>
+	int32 SampleWith(RandomType& Random) const;
+
+	int32 NumLive(int32 Node) const { return Nodes.IsEmpty() ? 0 : Nodes[Node].NumLive; }
+
+	// Grows the leaf count to a power of two of at least MinCapacity, keeping the entries
+	void Grow(int32 MinCapacity);
+
+	// Recomputes the ancestors of a leaf after it changed
+	void UpdateParents(int32 Node);
+
+	// Leaves start at Nodes[Capacity], node i has children 2i and 2i + 1, Nodes[0] is unused
+	TArray<FNode> Nodes;
+	// Whether the slot of each leaf is in use
+	TBitArray<> LiveMask;
+	TArray<int32> FreeIndices;
+	int32 Capacity = 0;
+	// One past the highest slot ever used, Add appends here when nothing is free
+	int32 NumSlots = 0;
+};
+
+/**
+ * UDynamicWeightedSampler wraps FWeightedSumTree for Blueprints, e.g. for a spawn director
+ * that adjusts individual weights every frame instead of rebuilding a weights array.
+ */
+UCLASS(BlueprintType)
+class RANCUTILITIES_API UDynamicWeightedSampler : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	// Creates a sampler where entry i starts with Weights[i]
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static UDynamicWeightedSampler* CreateDynamicWeightedSampler(UObject* Outer, const TArray<float>& Weights);
+
+	// Replaces every entry, entry i gets Weights[i]
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	void Build(const TArray<float>& Weights);
+
+	// Adds an entry and returns its index, which may be the slot of a removed entry
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	int Add(float Weight);
+
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	void Remove(int Index);
+
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	void SetWeight(int Index, float Weight);
+
+	// Weight of the entry at Index, 0 if there is none
+	UFUNCTION(BlueprintPure, Category = "WeightedRandomSelector")
+	float GetWeight(int Index) const;
+
+	UFUNCTION(BlueprintPure, Category = "WeightedRandomSelector")
+	float GetTotalWeight() const;
+
+	UFUNCTION(BlueprintPure, Category = "WeightedRandomSelector")
+	int32 Num() const;
+
+	// Draws the index of an entry, -1 if the sampler is empty
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	int Sample() const;
+
+	// Sample drawing from Stream
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	int SampleFromStream(const FRandomStream& Stream) const;
+
+	int Sample(FRancRandom& Random) const;
+
+	FWeightedSumTree& GetTree() { return Tree; }
+	const FWeightedSumTree& GetTree() const { return Tree; }
+
+private:
+	FWeightedSumTree Tree;
+};
@@ -0,0 +1,67 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+
+#include "ISortKeyProvider.generated.h"
+
+UENUM(BlueprintType)
+enum class ERancSortKeyType : uint8
+{
+	Float,
+	Int,
+	Name
+};
+
+// Key an ISortKeyProvider is sorted by. Keys of different types order by type, Float < Int < Name.
+USTRUCT(BlueprintType)
+struct RANCUTILITIES_API FRancSortKey
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sorting")
+	ERancSortKeyType Type = ERancSortKeyType::Float;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sorting")
+	float FloatKey = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sorting")
+	int64 IntKey = 0;
+
+	// Compared lexically, ignoring case
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sorting")
+	FName NameKey;
+
+	bool operator<(const FRancSortKey& Other) const
+	{
+		if (Type != Other.Type)
+		{
+			return Type < Other.Type;
+		}
+		switch (Type)
+		{
+		case ERancSortKeyType::Float: return FloatKey < Other.FloatKey;
+		case ERancSortKeyType::Int: return IntKey < Other.IntKey;
+		default: return NameKey.Compare(Other.NameKey) < 0;
+		}
+	}
+};
+
+UINTERFACE(BlueprintType)
+class RANCUTILITIES_API USortKeyProvider : public UInterface
+{
+	GENERATED_BODY()
+};
+
+// Alternative to ISortableElement: the sort asks each element for its key once instead of calling IsLessThan per comparison
+class RANCUTILITIES_API ISortKeyProvider
+{
+	GENERATED_BODY()
+
+public:
+	// Key this object is sorted by, ascending
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Sorting")
+	FRancSortKey GetSortKey() const;
+};
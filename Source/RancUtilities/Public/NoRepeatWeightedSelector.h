@@ -0,0 +1,118 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "DynamicWeightedSampler.h"
+#include "RancRandom.h"
+#include "WeightedRandomSelector.h"
+#include "NoRepeatWeightedSelector.generated.h"
+
+/**
+ * FNoRepeatWeightedSampler draws weighted indices while keeping recent picks from coming straight back.
+ *
+ * An entry picked by Draw gets a weight of 0 for the next ExcludeLastN draws, then starts back at
+ * Suppression times its weight and recovers linearly to its full weight over RecoveryDraws draws.
+ * The state lives inside the sampler: the weights sit in an FWeightedSumTree and the recent picks in a ring
+ * allocated by Build, so a draw is O((ExcludeLastN + RecoveryDraws) * log n) and never allocates.
+ *
+ * If every entry is excluded, e.g. ExcludeLastN is not smaller than the number of entries,
+ * the draw falls back to a uniform pick over all entries like the other selectors do for all-zero weights.
+ */
+struct RANCUTILITIES_API FNoRepeatWeightedSampler
+{
+	// Replaces every entry, entry i gets Weights[i], and clears the pick history
+	void Build(TConstArrayView<float> Weights, int32 InExcludeLastN = 1, float InSuppression = 1.0f, int32 InRecoveryDraws = 0);
+
+	// Draws an index and suppresses it, INDEX_NONE if there are no entries
+	int32 Draw();
+
+	// Draws from Random, for seeded or per-thread sampling
+	int32 Draw(FRancRandom& Random);
+
+	int32 Draw(const FRandomStream& Stream);
+
+	// Changes the full weight of an entry, any suppression still in effect applies to the new weight
+	void SetWeight(int32 Index, float Weight);
+
+	float GetWeight(int32 Index) const { return BaseWeights.IsValidIndex(Index) ? BaseWeights[Index] : 0.f; }
+
+	// Weight the entry has on the next draw, after suppression
+	float GetEffectiveWeight(int32 Index) const;
+
+	// Forgets every pick so all entries are back at their full weight
+	void ResetHistory();
+
+	int32 Num() const { return BaseWeights.Num(); }
+
+private:
+	// Suppresses the drawn entry and advances the suppression of the earlier picks
+	int32 RecordPick(int32 Index);
+
+	// Weight scale of an entry last picked on PickDraw
+	float GetScale(int64 PickDraw) const;
+
+	FWeightedSumTree Tree;
+	TArray<float> BaseWeights;
+	// Draw on which each entry was last picked, INDEX_NONE if it is outside the history
+	TArray<int64> LastPickDraws;
+	// The picks of the last ExcludeLastN + RecoveryDraws draws, pick d sits at d % History.Num()
+	TArray<int32> History;
+	int64 NumDraws = 0;
+	int32 ExcludeLastN = 0;
+	float Suppression = 1.0f;
+	int32 RecoveryDraws = 0;
+};
+
+/**
+ * UNoRepeatWeightedSelector wraps FNoRepeatWeightedSampler for Blueprints,
+ * e.g. for barks that should not play twice in a row.
+ */
+UCLASS(BlueprintType)
+class RANCUTILITIES_API UNoRepeatWeightedSelector : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	// Creates a selector over Items.
+	// @param ExcludeLastN - A picked item can't be picked again for this many draws.
+	// @param Suppression - Weight scale of an item right after its exclusion ends, 0 to 1.
+	// @param RecoveryDraws - Draws over which the weight then recovers to its full value.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static UNoRepeatWeightedSelector* CreateNoRepeatWeightedSelector(UObject* Outer, const TArray<FSWeightedItem>& Items, int ExcludeLastN = 1, float Suppression = 1.0f, int RecoveryDraws = 0);
+
+	// Replaces the items and clears the pick history
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	void SetItems(const TArray<FSWeightedItem>& InItems, int ExcludeLastN = 1, float Suppression = 1.0f, int RecoveryDraws = 0);
+
+	// Selects an item that was not picked recently, null if there are no items
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	UObject* SelectItem();
+
+	// Selects the index of an item that was not picked recently, -1 if there are no items
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	int SelectIndex();
+
+	// SelectItem drawing from Stream, the same seed and history give the same picks
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	UObject* SelectItemFromStream(const FRandomStream& Stream);
+
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	void SetItemWeight(int Index, float Weight);
+
+	// Forgets every pick so all items are back at their full weight
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	void ResetHistory();
+
+	UFUNCTION(BlueprintPure, Category = "WeightedRandomSelector")
+	const TArray<UObject*>& GetItems() const { return Items; }
+
+	FNoRepeatWeightedSampler& GetSampler() { return Sampler; }
+
+private:
+	UPROPERTY()
+	TArray<UObject*> Items;
+
+	FNoRepeatWeightedSampler Sampler;
+};
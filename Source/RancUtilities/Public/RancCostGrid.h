@@ -0,0 +1,113 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IntVector2D.h"
+#include "RancCostGrid.generated.h"
+
+namespace RancGrid
+{
+	// Neighbour offsets, the 4 straight directions first, then the 4 diagonals
+	constexpr int32 DirX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+	constexpr int32 DirY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+	// Index of the direction pointing the other way
+	constexpr int32 OppositeDirection[8] = {1, 0, 3, 2, 7, 6, 5, 4};
+
+	constexpr float Sqrt2 = 1.41421356f;
+
+	inline bool IsDiagonal(int32 Direction)
+	{
+		return Direction >= 4;
+	}
+}
+
+/**
+ * FRancCostGrid is a dense row-major grid of cell costs shared by the grid pathfinding utilities.
+ * Each cell stores the cost of entering it, 0 means the cell is blocked.
+ */
+USTRUCT(BlueprintType)
+struct FRancCostGrid
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+	int32 Width = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+	int32 Height = 0;
+
+	// Cost of entering each cell, indexed Y * Width + X. 0 means blocked.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+	TArray<uint8> Costs;
+
+	void Init(int32 InWidth, int32 InHeight, uint8 DefaultCost = 1)
+	{
+		Width = FMath::Max(InWidth, 0);
+		Height = FMath::Max(InHeight, 0);
+		Costs.Init(DefaultCost, Width * Height);
+	}
+
+	int32 Num() const
+	{
+		return Width * Height;
+	}
+
+	bool IsValid() const
+	{
+		return Width > 0 && Height > 0 && Costs.Num() == Width * Height;
+	}
+
+	bool IsValidCell(int32 X, int32 Y) const
+	{
+		return X >= 0 && Y >= 0 && X < Width && Y < Height;
+	}
+
+	bool IsValidCell(const FIntVector2D& Cell) const
+	{
+		return IsValidCell(Cell.X, Cell.Y);
+	}
+
+	int32 ToIndex(int32 X, int32 Y) const
+	{
+		return Y * Width + X;
+	}
+
+	int32 ToIndex(const FIntVector2D& Cell) const
+	{
+		return ToIndex(Cell.X, Cell.Y);
+	}
+
+	FIntVector2D ToCell(int32 Index) const
+	{
+		return FIntVector2D(Index % Width, Index / Width);
+	}
+
+	// Returns 0 (blocked) for cells outside the grid
+	uint8 GetCost(int32 X, int32 Y) const
+	{
+		return IsValidCell(X, Y) ? Costs[ToIndex(X, Y)] : 0;
+	}
+
+	bool IsWalkable(int32 X, int32 Y) const
+	{
+		return GetCost(X, Y) != 0;
+	}
+
+	bool IsWalkable(const FIntVector2D& Cell) const
+	{
+		return IsWalkable(Cell.X, Cell.Y);
+	}
+
+	// Whether a step from (X, Y) in Direction stays on walkable cells without cutting a blocked corner
+	bool CanStep(int32 X, int32 Y, int32 Direction) const
+	{
+		const int32 NextX = X + RancGrid::DirX[Direction];
+		const int32 NextY = Y + RancGrid::DirY[Direction];
+		if (!IsWalkable(NextX, NextY))
+		{
+			return false;
+		}
+		return !RancGrid::IsDiagonal(Direction) || (IsWalkable(NextX, Y) && IsWalkable(X, NextY));
+	}
+};
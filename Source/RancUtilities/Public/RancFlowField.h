@@ -0,0 +1,90 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "IntVector2D.h"
+#include "RancCostGrid.h"
+#include "TPriorityQueue.h"
+#include "RancFlowField.generated.h"
+
+/**
+ * URancFlowField integrates the cost to the nearest goal for every cell of an FRancCostGrid in one multi-source
+ * Dijkstra pass, and stores for each cell the neighbour to step to. Any number of agents can then follow the
+ * field with O(1) lookups instead of running one path search each.
+ *
+ * Cell costs can be changed afterwards with SetCellCost(s). Only the cells whose route depended on a changed cell
+ * are re-integrated, so opening or closing a door does not rebuild the whole field.
+ */
+UCLASS(BlueprintType)
+class RANCUTILITIES_API URancFlowField : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Creates a flow field and integrates it.
+	 * @param Outer The owner of the flow field.
+	 * @param Grid The cost grid, copied into the flow field.
+	 * @param Goals The cells to flow towards, agents move to whichever is cheapest to reach.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding|FlowField")
+	static URancFlowField* CreateFlowField(UObject* Outer, const FRancCostGrid& Grid, const TArray<FIntVector2D>& Goals);
+
+	// Replaces the grid and goals and integrates the whole field
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding|FlowField")
+	void Build(const FRancCostGrid& InGrid, const TArray<FIntVector2D>& InGoals);
+
+	// Changes the cost of one cell (0 blocks it) and re-integrates only the affected part of the field
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding|FlowField")
+	void SetCellCost(FIntVector2D Cell, uint8 Cost);
+
+	// Changes several cells at once with a single re-integration pass. Cells and Costs must have the same length.
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding|FlowField")
+	void SetCellCosts(const TArray<FIntVector2D>& Cells, const TArray<uint8>& Costs);
+
+	// Offset to the next cell towards the goal, (0, 0) on goals and on cells that can't reach a goal
+	UFUNCTION(BlueprintPure, Category = "Pathfinding|FlowField")
+	FIntVector2D GetFlowDirection(FIntVector2D Cell) const;
+
+	// Gets the next cell towards the goal, returns false on goals and on cells that can't reach a goal
+	UFUNCTION(BlueprintPure, Category = "Pathfinding|FlowField")
+	bool GetNextCell(FIntVector2D Cell, FIntVector2D& OutNextCell) const;
+
+	// Integrated cost from Cell to the cheapest goal, -1 if no goal can be reached
+	UFUNCTION(BlueprintPure, Category = "Pathfinding|FlowField")
+	float GetCostToGoal(FIntVector2D Cell) const;
+
+	UFUNCTION(BlueprintPure, Category = "Pathfinding|FlowField")
+	const FRancCostGrid& GetGrid() const;
+
+	// Raw access for native agents, indexed like FRancCostGrid. Unreachable cells hold TNumericLimits<float>::Max().
+	const TArray<float>& GetIntegrationField() const { return Integration; }
+	// Direction index into RancGrid::DirX/DirY per cell, INDEX_NONE on goals and unreachable cells
+	const TArray<int8>& GetDirectionField() const { return Directions; }
+
+private:
+	// Sets Index to the cheapest route through its neighbours and queues it, if it can reach any
+	void RecomputeFromNeighbours(int32 Index);
+
+	// Clears Index and every cell whose route passes through it, adding them to Invalidated
+	void InvalidateSubtree(int32 Index);
+
+	void QueueCell(int32 Index);
+
+	// Dijkstra from the queued cells, only ever lowering the integrated cost of neighbours
+	void Propagate();
+
+	FRancCostGrid Grid;
+	TBitArray<> GoalMask;
+
+	TArray<float> Integration;
+	TArray<int8> Directions;
+
+	// Scratch kept between updates. Integration costs only grow while popping, so a radix queue fits.
+	TRadixPriorityQueue<int32> Queue;
+	TArray<int32> QueueHandles;
+	TArray<int32> Invalidated;
+	TBitArray<> InvalidatedMask;
+};
@@ -0,0 +1,160 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "IntVector2D.h"
+#include "RancCostGrid.h"
+#include "TPriorityQueue.h"
+#include "RancGridPathfinder.generated.h"
+
+UENUM(BlueprintType)
+enum class ERancPathfindingAlgorithm : uint8
+{
+	AStar UMETA(DisplayName = "A*"),
+	// Only valid on uniform cost grids with diagonal movement, falls back to A* otherwise
+	JumpPointSearch UMETA(DisplayName = "Jump Point Search")
+};
+
+USTRUCT(BlueprintType)
+struct FRancGridPath
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pathfinding")
+	TArray<FIntVector2D> Cells;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pathfinding")
+	bool bFound = false;
+};
+
+/**
+ * Per-query working memory of URancGridPathfinder. Reusing one between queries avoids reallocating
+ * the open list and per-cell state, which is only lazily reset through a generation stamp.
+ * A scratch must not be shared between threads.
+ */
+struct FRancGridSearchScratch
+{
+	struct FNodeState
+	{
+		float G = 0.f;
+		int32 Parent = INDEX_NONE;
+		// Handle in Open, INDEX_NONE if not open, ClosedHandle once expanded
+		int32 OpenHandle = INDEX_NONE;
+		// The node state is only valid when this matches the scratch generation
+		uint32 Generation = 0;
+	};
+
+	static constexpr int32 ClosedHandle = -2;
+
+	TArray<FNodeState> Nodes;
+	TIndexedPriorityQueue<int32, float> Open;
+	uint32 Generation = 0;
+
+	// Readies the scratch for a new search over NumCells cells in O(1) unless the grid grew
+	void BeginSearch(int32 NumCells)
+	{
+		if (Nodes.Num() != NumCells)
+		{
+			Nodes.Reset();
+			Nodes.SetNum(NumCells);
+			Generation = 0;
+		}
+
+		if (++Generation == 0)
+		{
+			// The stamp wrapped, invalidate every node explicitly once
+			for (FNodeState& Node : Nodes)
+			{
+				Node.Generation = 0;
+			}
+			Generation = 1;
+		}
+		Open.Reset();
+	}
+
+	FNodeState& Touch(int32 Index)
+	{
+		FNodeState& Node = Nodes[Index];
+		if (Node.Generation != Generation)
+		{
+			Node.G = TNumericLimits<float>::Max();
+			Node.Parent = INDEX_NONE;
+			Node.OpenHandle = INDEX_NONE;
+			Node.Generation = Generation;
+		}
+		return Node;
+	}
+};
+
+/**
+ * URancGridPathfinder finds shortest paths on a dense FRancCostGrid with A* or Jump Point Search.
+ * Diagonal moves cost sqrt(2) times the entered cell's cost and never cut blocked corners.
+ * Scratch memory is kept between queries, and FindPaths resolves many queries in parallel on worker threads.
+ */
+UCLASS(BlueprintType)
+class RANCUTILITIES_API URancGridPathfinder : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Creates a pathfinder over a Width x Height grid where every cell has cost 1.
+	 * @param Outer The owner of the pathfinder.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+	static URancGridPathfinder* CreateGridPathfinder(UObject* Outer, int32 Width, int32 Height);
+
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+	void SetGrid(const FRancCostGrid& InGrid);
+
+	// Sets the cost of entering Cell, 0 blocks it
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+	void SetCellCost(FIntVector2D Cell, uint8 Cost);
+
+	UFUNCTION(BlueprintPure, Category = "Pathfinding")
+	const FRancCostGrid& GetGrid() const;
+
+	/**
+	 * Finds a path from Start to Goal, both included in OutPath.
+	 * @return Whether a path exists. OutPath is empty otherwise.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+	bool FindPath(FIntVector2D Start, FIntVector2D Goal, TArray<FIntVector2D>& OutPath);
+
+	/**
+	 * Resolves Starts[i] -> Goals[i] for every pair on worker threads and blocks until all are done.
+	 * OutPaths[i] holds the result of pair i.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+	void FindPaths(const TArray<FIntVector2D>& Starts, const TArray<FIntVector2D>& Goals, TArray<FRancGridPath>& OutPaths);
+
+	// Thread safe native query as long as the grid is not modified concurrently, each thread needs its own scratch
+	bool FindPathWithScratch(const FIntVector2D& Start, const FIntVector2D& Goal, TArray<FIntVector2D>& OutPath, FRancGridSearchScratch& Scratch) const;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pathfinding")
+	ERancPathfindingAlgorithm Algorithm = ERancPathfindingAlgorithm::JumpPointSearch;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pathfinding")
+	bool bAllowDiagonal = true;
+
+private:
+	bool RunAStar(int32 StartIndex, int32 GoalIndex, FRancGridSearchScratch& Scratch) const;
+	bool RunJumpPointSearch(int32 StartIndex, int32 GoalIndex, FRancGridSearchScratch& Scratch) const;
+
+	// Walks from (X, Y) in direction (DX, DY) and returns the index of the next jump point or INDEX_NONE
+	int32 Jump(int32 X, int32 Y, int32 DX, int32 DY, int32 GoalIndex) const;
+
+	float Heuristic(int32 FromIndex, int32 ToIndex) const;
+
+	// Follows parents from the goal, expanding straight and diagonal jumps into single cell steps
+	void BuildPath(int32 GoalIndex, const FRancGridSearchScratch& Scratch, TArray<FIntVector2D>& OutPath) const;
+
+	FRancCostGrid Grid;
+	// Cells with a cost above 1. Jump Point Search is only used while there are none.
+	int32 NumWeightedCells = 0;
+
+	FRancGridSearchScratch GameThreadScratch;
+	TArray<FRancGridSearchScratch> WorkerScratch;
+};
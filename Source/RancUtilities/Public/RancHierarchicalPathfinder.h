@@ -0,0 +1,196 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "IntVector2D.h"
+#include "RancCostGrid.h"
+#include "TPriorityQueue.h"
+#include "RancHierarchicalPathfinder.generated.h"
+
+/**
+ * A path found by URancHierarchicalPathfinder. Waypoints is the coarse route through cluster entrances,
+ * Cells is the concrete prefix refined so far and grows with every RefinePath call.
+ */
+USTRUCT(BlueprintType)
+struct FRancHierarchicalPath
+{
+	GENERATED_BODY()
+
+	// Start, the cluster entrances to pass through, and the goal
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pathfinding")
+	TArray<FIntVector2D> Waypoints;
+
+	// Concrete cells from the start up to the last refined waypoint
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pathfinding")
+	TArray<FIntVector2D> Cells;
+
+	// Index of the next waypoint RefinePath will refine towards
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pathfinding")
+	int32 NextWaypoint = 0;
+
+	bool IsFullyRefined() const
+	{
+		return NextWaypoint >= Waypoints.Num();
+	}
+};
+
+/**
+ * URancHierarchicalPathfinder implements HPA* over an FRancCostGrid for maps too large for flat A*.
+ *
+ * The grid is split into square clusters. Entrances are placed along the borders between neighbouring clusters
+ * and the cheapest in-cluster routes between the entrances of each cluster are precomputed as an abstract graph.
+ * Queries search the small abstract graph and only refine the concrete cells of the next few clusters on demand.
+ * Changing a cell only rebuilds the entrances and routes of its cluster and the borders it shares.
+ *
+ * Paths are near optimal rather than optimal, entrances restrict where clusters can be crossed.
+ */
+UCLASS(BlueprintType)
+class RANCUTILITIES_API URancHierarchicalPathfinder : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Creates a hierarchical pathfinder and builds its abstract graph.
+	 * @param Outer The owner of the pathfinder.
+	 * @param Grid The cost grid, copied into the pathfinder.
+	 * @param ClusterSize Width and height of a cluster in cells.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding|Hierarchical")
+	static URancHierarchicalPathfinder* CreateHierarchicalPathfinder(UObject* Outer, const FRancCostGrid& Grid, int32 ClusterSize = 16);
+
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding|Hierarchical")
+	void Build(const FRancCostGrid& InGrid, int32 InClusterSize = 16);
+
+	// Changes the cost of one cell (0 blocks it) and rebuilds only its cluster
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding|Hierarchical")
+	void SetCellCost(FIntVector2D Cell, uint8 Cost);
+
+	// Changes several cells and rebuilds every touched cluster once. Cells and Costs must have the same length.
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding|Hierarchical")
+	void SetCellCosts(const TArray<FIntVector2D>& Cells, const TArray<uint8>& Costs);
+
+	/**
+	 * Searches the abstract graph from Start to Goal and refines the first clusters of the route.
+	 * @param NumClustersToRefine How many clusters to refine right away, 0 or less refines the whole path.
+	 * @return Whether a route exists.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding|Hierarchical")
+	bool FindPath(FIntVector2D Start, FIntVector2D Goal, FRancHierarchicalPath& OutPath, int32 NumClustersToRefine = 2);
+
+	/**
+	 * Appends the concrete cells of the next clusters of Path to Path.Cells.
+	 * @param NumClusters How many more clusters to refine, 0 or less refines the rest of the path.
+	 * @return False if the route became blocked since it was found, search again in that case.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Pathfinding|Hierarchical")
+	bool RefinePath(UPARAM(ref) FRancHierarchicalPath& Path, int32 NumClusters = 2);
+
+	UFUNCTION(BlueprintPure, Category = "Pathfinding|Hierarchical")
+	const FRancCostGrid& GetGrid() const;
+
+	UFUNCTION(BlueprintPure, Category = "Pathfinding|Hierarchical")
+	int32 GetNumAbstractNodes() const;
+
+private:
+	struct FAbstractEdge
+	{
+		int32 ToNode;
+		float Cost;
+	};
+
+	// An entrance cell in the abstract graph
+	struct FAbstractNode
+	{
+		int32 CellIndex = INDEX_NONE;
+		// INDEX_NONE while the node is on the free list
+		int32 ClusterIndex = INDEX_NONE;
+		// Number of border transitions using this cell
+		int32 RefCount = 0;
+		TArray<FAbstractEdge> IntraEdges;
+		TArray<FAbstractEdge> InterEdges;
+	};
+
+	// A pair of facing entrance nodes on either side of a cluster border
+	struct FTransition
+	{
+		int32 NodeA;
+		int32 NodeB;
+	};
+
+	struct FClusterBounds
+	{
+		int32 MinX;
+		int32 MinY;
+		int32 SizeX;
+		int32 SizeY;
+
+		bool Contains(int32 X, int32 Y) const
+		{
+			return X >= MinX && Y >= MinY && X < MinX + SizeX && Y < MinY + SizeY;
+		}
+
+		int32 ToLocal(int32 X, int32 Y) const
+		{
+			return (Y - MinY) * SizeX + (X - MinX);
+		}
+	};
+
+	// Working memory of the in-cluster searches, indexed by local cell
+	struct FClusterSearch
+	{
+		TArray<float> Costs;
+		TArray<int32> Parents;
+		TArray<int32> Handles;
+		TIndexedPriorityQueue<int32, float> Open;
+		FClusterBounds Bounds;
+	};
+
+	int32 GetClusterIndex(int32 X, int32 Y) const;
+	FClusterBounds GetClusterBounds(int32 ClusterIndex) const;
+
+	// Rebuilds the borders and in-cluster routes of the given clusters, and the routes of the clusters around them
+	void RebuildClusters(const TArray<int32>& DirtyClusters);
+
+	// Border 2 * ClusterIndex is the east border of the cluster, 2 * ClusterIndex + 1 the north border
+	void ClearBorder(int32 BorderIndex);
+	void BuildBorder(int32 BorderIndex);
+	void AddTransition(int32 BorderIndex, int32 CellA, int32 CellB);
+	int32 GetOrCreateNode(int32 CellIndex);
+	void ReleaseNode(int32 NodeIndex);
+	void BuildIntraEdges(int32 ClusterIndex);
+
+	/**
+	 * Searches inside one cluster from SourceCell, as A* towards GoalCell or as a full Dijkstra when GoalCell is INDEX_NONE.
+	 * With bReverse the costs are of travelling to SourceCell rather than from it.
+	 * Results are left in ClusterSearch.
+	 */
+	bool RunClusterSearch(int32 ClusterIndex, int32 SourceCell, int32 GoalCell, bool bReverse);
+
+	// Cost found by the last RunClusterSearch to CellIndex, which must be inside the searched cluster
+	float GetClusterSearchCost(int32 CellIndex) const;
+
+	float OctileDistance(int32 CellA, int32 CellB) const;
+
+	FRancCostGrid Grid;
+	int32 ClusterSize = 16;
+	int32 NumClustersX = 0;
+	int32 NumClustersY = 0;
+
+	TArray<FAbstractNode> Nodes;
+	TArray<int32> FreeNodes;
+	TMap<int32, int32> CellToNode;
+	// Live abstract nodes per cluster
+	TArray<TArray<int32>> ClusterNodes;
+	TArray<TArray<FTransition>> Borders;
+
+	FClusterSearch ClusterSearch;
+
+	// Abstract search scratch
+	TArray<float> AbstractCosts;
+	TArray<int32> AbstractParents;
+	TArray<int32> AbstractHandles;
+	TIndexedPriorityQueue<int32, float> AbstractOpen;
+};
@@ -0,0 +1,92 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "RancRandom.h"
+#include "WeightedAliasTable.h"
+#include "RancLootTableSubsystem.generated.h"
+
+/**
+ * Row of a loot table DataTable. A row either drops Item or, if NestedTable is set, rolls that table instead.
+ */
+USTRUCT(BlueprintType)
+struct RANCUTILITIES_API FRancLootTableRow : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LootTable")
+	UObject* Item = nullptr;
+
+	// Rows with a weight of 0 or less never drop
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LootTable")
+	float Weight = 1.0f;
+
+	// Another FRancLootTableRow table rolled in place of Item, its weights share this row's weight
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LootTable", meta = (RequiredAssetDataTags = "RowStructure=/Script/RancUtilities.RancLootTableRow"))
+	UDataTable* NestedTable = nullptr;
+};
+
+/**
+ * URancLootTableSubsystem rolls FRancLootTableRow DataTables.
+ *
+ * Each table is compiled once into a flat FWeightedAliasTable, with nested tables flattened into it,
+ * so a roll is an O(1) lookup instead of building an array and scanning it.
+ * A compiled table is dropped when it or any table nested in it changes, e.g. on reimport or edit,
+ * and rebuilt on its next roll. Call PrecompileLootTable while loading to avoid the cost on the first roll.
+ *
+ * The compiled tables don't own the items, the DataTables already keep them alive.
+ */
+UCLASS()
+class RANCUTILITIES_API URancLootTableSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// Rolls one item from Table, null if the table has no droppable rows
+	UFUNCTION(BlueprintCallable, Category = "LootTable")
+	UObject* RollLootTable(UDataTable* Table);
+
+	// Rolls Count items from Table, with replacement
+	UFUNCTION(BlueprintCallable, Category = "LootTable")
+	TArray<UObject*> RollLootTableMany(UDataTable* Table, int32 Count);
+
+	// Compiles Table now so the first roll doesn't have to
+	UFUNCTION(BlueprintCallable, Category = "LootTable")
+	void PrecompileLootTable(UDataTable* Table);
+
+	// Drops the compiled form of Table and of every table nesting it, they are rebuilt on their next roll
+	UFUNCTION(BlueprintCallable, Category = "LootTable")
+	void InvalidateLootTable(UDataTable* Table);
+
+	UObject* RollLootTable(UDataTable* Table, FRancRandom& Random);
+
+private:
+	struct FCompiledLootTable
+	{
+		FWeightedAliasTable Sampler;
+		TArray<UObject*> Items;
+		// Every table flattened into this one, including itself
+		TArray<TObjectKey<UDataTable>> Dependencies;
+	};
+
+	// Compiles Table if needed. Null if the table has the wrong row struct.
+	const FCompiledLootTable* FindOrCompile(UDataTable* Table);
+
+	// Appends the droppable rows of Table, with nested tables flattened in, and returns the total weight appended
+	double Flatten(UDataTable* Table, TArray<UDataTable*>& Stack, TArray<TObjectKey<UDataTable>>& Dependencies,
+		TArray<UObject*>& OutItems, TArray<double>& OutWeights);
+
+	void WatchTable(UDataTable* Table);
+
+	void HandleDataTableChanged(TObjectKey<UDataTable> Table);
+
+	TMap<TObjectKey<UDataTable>, FCompiledLootTable> CompiledTables;
+	// Change listeners of every table that any compiled table depends on
+	TMap<TObjectKey<UDataTable>, FDelegateHandle> WatchedTables;
+};
@@ -0,0 +1,98 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+#include "Misc/App.h"
+
+/**
+ * Parallel merge sort for large arrays of keys or indices.
+ * The array is split into one chunk per worker, the chunks are sorted with ParallelFor and then merged pairwise,
+ * each merge level again in parallel, through one scratch copy of the array.
+ * Below MinParallelNum elements, or without worker threads, it falls back to Algo::Sort.
+ *
+ * Like TArray::Sort the result is not stable, include a tie-break such as the index in Predicate if the order of
+ * equal elements matters. Predicate is called from several threads at once and must not write shared state.
+ */
+namespace RancParallelSort
+{
+	// Below this size splitting the work costs more than it saves
+	constexpr int32 DefaultMinParallelNum = 16 * 1024;
+
+	template <typename T, typename PredicateType>
+	void Sort(TArrayView<T> Array, PredicateType Predicate, int32 MinParallelNum = DefaultMinParallelNum)
+	{
+		const int32 Num = Array.Num();
+		const int32 NumWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+		if (Num < FMath::Max(MinParallelNum, 2) || NumWorkers < 2 || !FApp::ShouldUseThreadingForPerformance())
+		{
+			Algo::Sort(Array, Predicate);
+			return;
+		}
+
+		// A power of two so every merge level pairs the runs up exactly
+		int32 NumChunks = static_cast<int32>(FMath::RoundUpToPowerOfTwo(static_cast<uint32>(NumWorkers)));
+		while (NumChunks > Num / 2)
+		{
+			NumChunks /= 2;
+		}
+		const auto RunStart = [Num, NumChunks](int32 Chunk)
+		{
+			return static_cast<int32>(static_cast<int64>(Num) * Chunk / NumChunks);
+		};
+
+		ParallelFor(NumChunks, [&](int32 Chunk)
+		{
+			const int32 Start = RunStart(Chunk);
+			Algo::Sort(Array.Slice(Start, RunStart(Chunk + 1) - Start), Predicate);
+		});
+
+		TArray<T> Scratch(Array.GetData(), Num);
+		T* Source = Array.GetData();
+		T* Dest = Scratch.GetData();
+
+		// Each level merges runs of RunChunks chunks into runs twice as long, the last level is a single merge
+		for (int32 RunChunks = 1; RunChunks < NumChunks; RunChunks *= 2)
+		{
+			ParallelFor(NumChunks / (RunChunks * 2), [&](int32 Pair)
+			{
+				const int32 Start = RunStart(Pair * RunChunks * 2);
+				const int32 Mid = RunStart(Pair * RunChunks * 2 + RunChunks);
+				const int32 End = RunStart((Pair + 1) * RunChunks * 2);
+
+				int32 Left = Start;
+				int32 Right = Mid;
+				int32 Out = Start;
+				while (Left < Mid && Right < End)
+				{
+					Dest[Out++] = Predicate(Source[Right], Source[Left]) ? MoveTemp(Source[Right++]) : MoveTemp(Source[Left++]);
+				}
+				while (Left < Mid)
+				{
+					Dest[Out++] = MoveTemp(Source[Left++]);
+				}
+				while (Right < End)
+				{
+					Dest[Out++] = MoveTemp(Source[Right++]);
+				}
+			});
+			Swap(Source, Dest);
+		}
+
+		if (Source != Array.GetData())
+		{
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Array[i] = MoveTemp(Source[i]);
+			}
+		}
+	}
+
+	template <typename T, typename PredicateType>
+	void Sort(TArray<T>& Array, PredicateType Predicate, int32 MinParallelNum = DefaultMinParallelNum)
+	{
+		Sort(MakeArrayView(Array), Predicate, MinParallelNum);
+	}
+}
@@ -0,0 +1,187 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <type_traits>
+
+/**
+ * Scratch memory of the radix sorts. Keep one around, e.g. per thread or per system,
+ * so repeated sorts of similar sizes don't allocate.
+ */
+struct FRancRadixSortScratch
+{
+	// Grows the buffer to at least NumBytes and returns it, 8 byte aligned
+	uint8* Reserve(int64 NumBytes)
+	{
+		const int64 NumWords = (NumBytes + 7) / 8;
+		if (Storage.Num() < NumWords)
+		{
+			Storage.SetNumUninitialized(NumWords);
+		}
+		return reinterpret_cast<uint8*>(Storage.GetData());
+	}
+
+	void Empty() { Storage.Empty(); }
+
+private:
+	TArray<uint64, TSizedDefaultAllocator<64>> Storage;
+};
+
+/**
+ * LSD radix sorts for numeric keys with a payload, O(n) per pass with one 8 bit digit per pass.
+ * 32 bit keys take up to 4 passes and 64 bit keys up to 8, passes where every key has the same digit are skipped.
+ * The sort is stable, so equal keys keep the order of their payloads.
+ *
+ * Floats are ordered by flipping their bits into unsigned integers: -0 sorts before +0 and NaNs sort
+ * before -inf or after +inf depending on their sign bit.
+ */
+namespace RancRadixSort
+{
+	// Unsigned integers that order like the keys
+	inline uint32 ToRadixKey(uint32 Key) { return Key; }
+	inline uint64 ToRadixKey(uint64 Key) { return Key; }
+	inline uint32 ToRadixKey(int32 Key) { return static_cast<uint32>(Key) ^ 0x80000000u; }
+	inline uint64 ToRadixKey(int64 Key) { return static_cast<uint64>(Key) ^ 0x8000000000000000ull; }
+
+	// Negative floats have all bits flipped so larger magnitudes sort first, positive floats only the sign bit
+	inline uint32 ToRadixKey(float Key)
+	{
+		const uint32 Bits = FMath::AsUInt(Key);
+		return Bits ^ ((Bits >> 31) ? 0xFFFFFFFFu : 0x80000000u);
+	}
+
+	inline uint64 ToRadixKey(double Key)
+	{
+		const uint64 Bits = FMath::AsUInt(Key);
+		return Bits ^ ((Bits >> 63) ? 0xFFFFFFFFFFFFFFFFull : 0x8000000000000000ull);
+	}
+
+	inline void FromRadixKey(uint32 RadixKey, uint32& OutKey) { OutKey = RadixKey; }
+	inline void FromRadixKey(uint64 RadixKey, uint64& OutKey) { OutKey = RadixKey; }
+	inline void FromRadixKey(uint32 RadixKey, int32& OutKey) { OutKey = static_cast<int32>(RadixKey ^ 0x80000000u); }
+	inline void FromRadixKey(uint64 RadixKey, int64& OutKey) { OutKey = static_cast<int64>(RadixKey ^ 0x8000000000000000ull); }
+
+	inline void FromRadixKey(uint32 RadixKey, float& OutKey)
+	{
+		OutKey = FMath::AsFloat(RadixKey ^ ((RadixKey >> 31) ? 0x80000000u : 0xFFFFFFFFu));
+	}
+
+	inline void FromRadixKey(uint64 RadixKey, double& OutKey)
+	{
+		OutKey = FMath::AsFloat(RadixKey ^ ((RadixKey >> 63) ? 0x8000000000000000ull : 0xFFFFFFFFFFFFFFFFull));
+	}
+
+	namespace Private
+	{
+		/**
+		 * Sorts the radix keys GetRadixKey(i) for i < Num and moves Payloads along.
+		 * Returns the sorted radix keys, which live in Scratch until its next use.
+		 */
+		template <typename FRadixKey, typename PayloadType, typename GetRadixKeyType>
+		const FRadixKey* SortRadixKeys(int32 Num, GetRadixKeyType GetRadixKey, PayloadType* Payloads, FRancRadixSortScratch& Scratch)
+		{
+			static_assert(std::is_trivially_copyable_v<PayloadType>, "Radix sort payloads are copied as raw memory.");
+			constexpr int32 NumPasses = sizeof(FRadixKey);
+
+			// Scratch holds two key buffers and one payload buffer, the payloads ping-pong with the caller's array
+			const int64 KeyBytes = Align(static_cast<int64>(Num) * sizeof(FRadixKey), 8);
+			uint8* Memory = Scratch.Reserve(KeyBytes * 2 + static_cast<int64>(Num) * sizeof(PayloadType));
+			FRadixKey* SourceKeys = reinterpret_cast<FRadixKey*>(Memory);
+			FRadixKey* DestKeys = reinterpret_cast<FRadixKey*>(Memory + KeyBytes);
+			PayloadType* SourcePayloads = Payloads;
+			PayloadType* DestPayloads = reinterpret_cast<PayloadType*>(Memory + KeyBytes * 2);
+
+			// Every pass's histogram is counted in one read of the keys
+			uint32 Counts[NumPasses][256] = {};
+			for (int32 i = 0; i < Num; ++i)
+			{
+				const FRadixKey RadixKey = GetRadixKey(i);
+				SourceKeys[i] = RadixKey;
+				for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+				{
+					++Counts[Pass][(RadixKey >> (Pass * 8)) & 0xFF];
+				}
+			}
+
+			for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+			{
+				const int32 Shift = Pass * 8;
+				uint32* PassCounts = Counts[Pass];
+				if (PassCounts[(SourceKeys[0] >> Shift) & 0xFF] == static_cast<uint32>(Num))
+				{
+					continue;
+				}
+
+				uint32 Offset = 0;
+				for (int32 Digit = 0; Digit < 256; ++Digit)
+				{
+					const uint32 Count = PassCounts[Digit];
+					PassCounts[Digit] = Offset;
+					Offset += Count;
+				}
+
+				for (int32 i = 0; i < Num; ++i)
+				{
+					const uint32 Dest = PassCounts[(SourceKeys[i] >> Shift) & 0xFF]++;
+					DestKeys[Dest] = SourceKeys[i];
+					DestPayloads[Dest] = SourcePayloads[i];
+				}
+				Swap(SourceKeys, DestKeys);
+				Swap(SourcePayloads, DestPayloads);
+			}
+
+			if (SourcePayloads != Payloads)
+			{
+				FMemory::Memcpy(Payloads, SourcePayloads, static_cast<SIZE_T>(Num) * sizeof(PayloadType));
+			}
+			return SourceKeys;
+		}
+	}
+
+	/**
+	 * Sorts Keys and moves Payloads[i] along with Keys[i].
+	 * KeyType is int32, uint32, int64, uint64, float or double. PayloadType has to be trivially copyable.
+	 */
+	template <typename KeyType, typename PayloadType>
+	void SortPairs(TArrayView<KeyType> Keys, TArrayView<PayloadType> Payloads, FRancRadixSortScratch& Scratch, bool bDescending = false)
+	{
+		using FRadixKey = decltype(ToRadixKey(KeyType()));
+		check(Keys.Num() == Payloads.Num());
+		const int32 Num = Keys.Num();
+		if (Num < 2)
+		{
+			return;
+		}
+
+		// Descending flips every bit, which reverses the order and keeps the sort stable
+		const FRadixKey Flip = bDescending ? static_cast<FRadixKey>(~FRadixKey(0)) : FRadixKey(0);
+		const FRadixKey* SortedKeys = Private::SortRadixKeys<FRadixKey>(Num, [&Keys, Flip](int32 i) { return ToRadixKey(Keys[i]) ^ Flip; }, Payloads.GetData(), Scratch);
+		for (int32 i = 0; i < Num; ++i)
+		{
+			FromRadixKey(static_cast<FRadixKey>(SortedKeys[i] ^ Flip), Keys[i]);
+		}
+	}
+
+	// Fills OutIndices with the indices of Keys in sorted order without moving the keys, equal keys keep their index order
+	template <typename KeyType>
+	void SortIndices(TConstArrayView<KeyType> Keys, TArray<int32>& OutIndices, FRancRadixSortScratch& Scratch, bool bDescending = false)
+	{
+		using FRadixKey = decltype(ToRadixKey(KeyType()));
+		OutIndices.SetNumUninitialized(Keys.Num());
+		for (int32 i = 0; i < Keys.Num(); ++i)
+		{
+			OutIndices[i] = i;
+		}
+		if (Keys.Num() < 2)
+		{
+			return;
+		}
+
+		const FRadixKey Flip = bDescending ? static_cast<FRadixKey>(~FRadixKey(0)) : FRadixKey(0);
+		Private::SortRadixKeys<FRadixKey>(Keys.Num(), [&Keys, Flip](int32 i) { return ToRadixKey(Keys[i]) ^ Flip; }, OutIndices.GetData(), Scratch);
+	}
+
+	// Scratch for callers without their own, one per thread
+	RANCUTILITIES_API FRancRadixSortScratch& GetThreadScratch();
+}
@@ -0,0 +1,131 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FRancRandom is a small, fast, seedable generator (PCG32) for the random utilities of this plugin.
+ *
+ * Purpose:
+ * - Reproducible results: the same seed gives the same sequence, e.g. for replays or seeded procedural generation.
+ * - Parallel work: each thread or task owns its generator, so nothing is shared or locked,
+ *   unlike the global FMath::Rand family.
+ *
+ * Features:
+ * - The same FRand, FRandRange, RandHelper and RandRange calls as FRandomStream.
+ * - Streams: generators with the same seed but a different Stream produce independent sequences,
+ *   so a parallel job can give task i the stream i and get the same result however the tasks are scheduled.
+ */
+struct FRancRandom
+{
+	FRancRandom()
+	{
+		Initialize(0);
+	}
+
+	explicit FRancRandom(uint64 Seed, uint64 Stream = 0)
+	{
+		Initialize(Seed, Stream);
+	}
+
+	void Initialize(uint64 Seed, uint64 Stream = 0)
+	{
+		State = 0;
+		Increment = (Stream << 1) | 1;
+		GetUnsignedInt();
+		State += Seed;
+		GetUnsignedInt();
+	}
+
+	uint32 GetUnsignedInt()
+	{
+		const uint64 OldState = State;
+		State = OldState * 6364136223846793005ull + Increment;
+		const uint32 XorShifted = static_cast<uint32>(((OldState >> 18) ^ OldState) >> 27);
+		const uint32 Rotation = static_cast<uint32>(OldState >> 59);
+		return (XorShifted >> Rotation) | (XorShifted << ((0u - Rotation) & 31));
+	}
+
+	// Uniform float in [0, 1)
+	float FRand()
+	{
+		return static_cast<float>(GetUnsignedInt() >> 8) * (1.f / 16777216.f);
+	}
+
+	// Uniform float in [Min, Max)
+	float FRandRange(float Min, float Max)
+	{
+		return Min + (Max - Min) * FRand();
+	}
+
+	// Uniform integer in [0, Max), 0 if Max <= 0
+	int32 RandHelper(int32 Max)
+	{
+		return Max > 0 ? static_cast<int32>(Bounded(static_cast<uint32>(Max))) : 0;
+	}
+
+	// Uniform integer in [Min, Max], both inclusive
+	int32 RandRange(int32 Min, int32 Max)
+	{
+		if (Max <= Min)
+		{
+			return Min;
+		}
+		const uint32 Range = static_cast<uint32>(Max) - static_cast<uint32>(Min) + 1u;
+		// A range of 0 means the full 32 bit span
+		return static_cast<int32>(static_cast<uint32>(Min) + (Range ? Bounded(Range) : GetUnsignedInt()));
+	}
+
+private:
+	// Lemire's multiply-shift with rejection, unbiased and without a division in the common case
+	uint32 Bounded(uint32 Range)
+	{
+		uint64 Product = static_cast<uint64>(GetUnsignedInt()) * Range;
+		uint32 Low = static_cast<uint32>(Product);
+		if (Low < Range)
+		{
+			const uint32 Threshold = (0u - Range) % Range;
+			while (Low < Threshold)
+			{
+				Product = static_cast<uint64>(GetUnsignedInt()) * Range;
+				Low = static_cast<uint32>(Product);
+			}
+		}
+		return static_cast<uint32>(Product >> 32);
+	}
+
+	uint64 State = 0;
+	uint64 Increment = 1;
+};
+
+/**
+ * Forwards the FRandomStream style calls to the global FMath generator,
+ * so code written against a generator type can also run on the default random source.
+ */
+struct FRancGlobalRandom
+{
+	float FRand() const { return FMath::FRand(); }
+	float FRandRange(float Min, float Max) const { return FMath::FRandRange(Min, Max); }
+	int32 RandHelper(int32 Max) const { return FMath::RandHelper(Max); }
+	int32 RandRange(int32 Min, int32 Max) const { return FMath::RandRange(Min, Max); }
+};
+
+namespace RancRandom
+{
+	/**
+	 * Generator owned by the calling thread, no locking or sharing involved.
+	 * Each thread gets its own stream of the seed set with SetThreadStreamSeed, or of a time based seed by default.
+	 * Which thread runs which task is not deterministic, so use MakeTaskStream where results must be reproducible.
+	 */
+	RANCUTILITIES_API FRancRandom& GetThreadStream();
+
+	// Reseeds every thread stream, each thread picks the new seed up on its next GetThreadStream call
+	RANCUTILITIES_API void SetThreadStreamSeed(uint64 Seed);
+
+	// Independent generator for task TaskIndex of a job seeded with Seed
+	inline FRancRandom MakeTaskStream(uint64 Seed, uint64 TaskIndex)
+	{
+		return FRancRandom(Seed, TaskIndex);
+	}
+}
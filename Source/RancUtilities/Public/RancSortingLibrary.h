@@ -3,10 +3,27 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "ISortKeyProvider.h"
+#include "UObject/UnrealType.h"
 #include "RancSortingLibrary.generated.h"
 
 DECLARE_DYNAMIC_DELEGATE_RetVal_TwoParams(bool, FCompareDelegate, const UObject*, ElementA, const UObject*, ElementB);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAsyncSortCompleted, const TArray<UObject*>&, SortedArray);
+
+// One key of a SortByProperties call, later keys break ties of earlier ones
+USTRUCT(BlueprintType)
+struct RANCUTILITIES_API FRancSortProperty
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sorting")
+	FName PropertyName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sorting")
+	bool bDescending = false;
+};
 
 UCLASS()
 class RANCUTILITIES_API URancSortingLibrary : public UBlueprintFunctionLibrary
@@ -22,4 +39,167 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Sorting", BlueprintPure)
 	static TArray<UObject*> GetSortedArrayCopyWithDelegate(const TArray<UObject*>& ArrayToSort, const FCompareDelegate& ComparisonFunction);
+
+	// Moves the K smallest ISortableElement objects, in order, to the front of ArrayToSort in O(n log K).
+	// The other objects follow in their original order.
+	UFUNCTION(BlueprintCallable, Category = "Sorting")
+	static void PartialSortSortableArray(UPARAM(ref) TArray<UObject*>& ArrayToSort, int32 K);
+
+	UFUNCTION(BlueprintCallable, Category = "Sorting")
+	static void PartialSortArrayWithDelegate(UPARAM(ref) TArray<UObject*>& ArrayToSort, int32 K, const FCompareDelegate& ComparisonFunction);
+
+	// Puts the object that sorting would place at index N there, with no greater objects before it and no smaller
+	// objects after it, in expected O(n). The order on either side is unspecified.
+	UFUNCTION(BlueprintCallable, Category = "Sorting")
+	static void NthElementSortableArray(UPARAM(ref) TArray<UObject*>& ArrayToSort, int32 N);
+
+	UFUNCTION(BlueprintCallable, Category = "Sorting")
+	static void NthElementArrayWithDelegate(UPARAM(ref) TArray<UObject*>& ArrayToSort, int32 N, const FCompareDelegate& ComparisonFunction);
+
+	// The first K objects of GetSortedArrayCopy without sorting or copying the whole array, O(n log K)
+	UFUNCTION(BlueprintCallable, Category = "Sorting", BlueprintPure)
+	static TArray<UObject*> SelectTopK(const TArray<UObject*>& Array, int32 K);
+
+	// The first K objects of GetSortedArrayCopyWithDelegate, O(n log K)
+	UFUNCTION(BlueprintCallable, Category = "Sorting", BlueprintPure)
+	static TArray<UObject*> SelectTopKWithDelegate(const TArray<UObject*>& Array, int32 K, const FCompareDelegate& ComparisonFunction);
+
+	// Sorts ISortKeyProvider objects by their keys. Each key is read once, so a Blueprint implementation runs n times
+	// instead of once per comparison like IsLessThan. Objects that don't provide a key keep their order at the end.
+	UFUNCTION(BlueprintCallable, Category = "Sorting")
+	static void SortByKey(UPARAM(ref) TArray<UObject*>& ArrayToSort);
+
+	UFUNCTION(BlueprintCallable, Category = "Sorting", BlueprintPure)
+	static TArray<UObject*> GetSortedArrayCopyByKey(const TArray<UObject*>& ArrayToSort);
+
+	UFUNCTION(BlueprintPure, Category = "Sorting")
+	static FRancSortKey MakeFloatSortKey(float Key);
+
+	UFUNCTION(BlueprintPure, Category = "Sorting")
+	static FRancSortKey MakeIntSortKey(int64 Key);
+
+	UFUNCTION(BlueprintPure, Category = "Sorting")
+	static FRancSortKey MakeNameSortKey(FName Key);
+
+	// Sorts objects by the UPROPERTY named PropertyName. The property is resolved once per class and its values are
+	// read straight into a key buffer, so no Blueprint runs during the sort.
+	// Numeric, bool, enum, FName and FString properties are supported, names and strings compare ignoring case.
+	// Objects without the property keep their order at the end.
+	UFUNCTION(BlueprintCallable, Category = "Sorting")
+	static void SortByProperty(UPARAM(ref) TArray<UObject*>& ArrayToSort, FName PropertyName, bool bDescending = false);
+
+	// SortByProperty with tie-breaks, objects are ordered by the first key, then the second and so on
+	UFUNCTION(BlueprintCallable, Category = "Sorting")
+	static void SortByProperties(UPARAM(ref) TArray<UObject*>& ArrayToSort, const TArray<FRancSortProperty>& SortProperties);
+
+	// SortByProperty for an array of structs
+	UFUNCTION(BlueprintCallable, CustomThunk, Category = "Sorting", meta = (ArrayParm = "TargetArray"))
+	static void SortStructArrayByProperty(UPARAM(ref) TArray<int32>& TargetArray, FName PropertyName, bool bDescending = false);
+
+	// SortByProperties for an array of structs
+	UFUNCTION(BlueprintCallable, CustomThunk, Category = "Sorting", meta = (ArrayParm = "TargetArray"))
+	static void SortStructArrayByProperties(UPARAM(ref) TArray<int32>& TargetArray, const TArray<FRancSortProperty>& SortProperties);
+
+	// Radix sorts Keys and reorders Values along with them in O(n), equal keys keep their order.
+	// Keys and Values must have the same length. Values can be indices into another array.
+	UFUNCTION(BlueprintCallable, Category = "Sorting")
+	static void RadixSortFloatPairs(UPARAM(ref) TArray<float>& Keys, UPARAM(ref) TArray<int32>& Values, bool bDescending = false);
+
+	UFUNCTION(BlueprintCallable, Category = "Sorting")
+	static void RadixSortIntPairs(UPARAM(ref) TArray<int32>& Keys, UPARAM(ref) TArray<int32>& Values, bool bDescending = false);
+
+	// RadixSortIntPairs for 64 bit keys such as timestamps
+	UFUNCTION(BlueprintCallable, Category = "Sorting")
+	static void RadixSortInt64Pairs(UPARAM(ref) TArray<int64>& Keys, UPARAM(ref) TArray<int32>& Values, bool bDescending = false);
+
+	// Radix sorts Objects by their Keys, e.g. distances computed beforehand
+	UFUNCTION(BlueprintCallable, Category = "Sorting")
+	static void RadixSortObjectsByFloat(UPARAM(ref) TArray<float>& Keys, UPARAM(ref) TArray<UObject*>& Objects, bool bDescending = false);
+
+	// Native path of the struct array sorts, ArrayProperty describes the array at TargetArray
+	static void GenericSortStructArrayByProperties(void* TargetArray, const FArrayProperty* ArrayProperty, TConstArrayView<FRancSortProperty> SortProperties);
+
+	DECLARE_FUNCTION(execSortStructArrayByProperty)
+	{
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FArrayProperty>(nullptr);
+		void* ArrayAddr = Stack.MostRecentPropertyAddress;
+		FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Stack.MostRecentProperty);
+		if (!ArrayProperty)
+		{
+			Stack.bArrayContextFailed = true;
+			return;
+		}
+
+		P_GET_PROPERTY(FNameProperty, PropertyName);
+		P_GET_UBOOL(bDescending);
+		P_FINISH;
+
+		P_NATIVE_BEGIN;
+		FRancSortProperty SortProperty;
+		SortProperty.PropertyName = PropertyName;
+		SortProperty.bDescending = bDescending;
+		GenericSortStructArrayByProperties(ArrayAddr, ArrayProperty, MakeArrayView(&SortProperty, 1));
+		P_NATIVE_END;
+	}
+
+	DECLARE_FUNCTION(execSortStructArrayByProperties)
+	{
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FArrayProperty>(nullptr);
+		void* ArrayAddr = Stack.MostRecentPropertyAddress;
+		FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Stack.MostRecentProperty);
+		if (!ArrayProperty)
+		{
+			Stack.bArrayContextFailed = true;
+			return;
+		}
+
+		P_GET_TARRAY_REF(FRancSortProperty, SortProperties);
+		P_FINISH;
+
+		P_NATIVE_BEGIN;
+		GenericSortStructArrayByProperties(ArrayAddr, ArrayProperty, SortProperties);
+		P_NATIVE_END;
+	}
+};
+
+/**
+ * Latent sort nodes for large arrays. The keys are read on the game thread, sorted on a worker thread,
+ * in parallel for large arrays, and Completed fires on the game thread with the sorted copy.
+ * Objects destroyed while the sort runs come out as null.
+ */
+UCLASS()
+class RANCUTILITIES_API URancAsyncSortAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintAssignable)
+	FOnAsyncSortCompleted Completed;
+
+	// SortByProperties without stalling the game thread
+	UFUNCTION(BlueprintCallable, Category = "Sorting", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static URancAsyncSortAction* SortByPropertiesAsync(UObject* WorldContextObject, const TArray<UObject*>& ArrayToSort, const TArray<FRancSortProperty>& SortProperties);
+
+	// SortByKey without stalling the game thread, GetSortKey still runs on the game thread
+	UFUNCTION(BlueprintCallable, Category = "Sorting", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static URancAsyncSortAction* SortByKeyAsync(UObject* WorldContextObject, const TArray<UObject*>& ArrayToSort);
+
+	virtual void Activate() override;
+
+private:
+	void Finish(TConstArrayView<int32> Positions);
+
+	UPROPERTY()
+	TArray<UObject*> Source;
+
+	UPROPERTY()
+	TArray<UObject*> Keyed;
+
+	UPROPERTY()
+	TArray<UObject*> Unkeyed;
+
+	TArray<FRancSortProperty> SortProperties;
+	bool bSortByKey = false;
 };
\ No newline at end of file
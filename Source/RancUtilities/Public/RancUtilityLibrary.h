@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "RancRandom.h"
 #include "RancUtilityLibrary.generated.h"
 
 class UActorComponent;
@@ -100,6 +101,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Flow Control", meta = (ExpandEnumAsExecs = "Branches"))
 	static void RandomBranch(float Chance1, float Chance2, float Chance3, ERandomBranchState& Branches);
 
+	/* RandomBranch drawing from Stream, the same seed takes the same branches. */
+	UFUNCTION(BlueprintCallable, Category = "Flow Control", meta = (ExpandEnumAsExecs = "Branches"))
+	static void RandomBranchFromStream(const FRandomStream& Stream, float Chance1, float Chance2, float Chance3, ERandomBranchState& Branches);
+
+	/* RandomBranch drawing from a native generator, e.g. RancRandom::GetThreadStream() on worker threads. */
+	static void RandomBranch(FRancRandom& Random, float Chance1, float Chance2, float Chance3, ERandomBranchState& Branches);
+
 	/* Calculates a location in front of the actor by a specified distance.	 */
 	UFUNCTION(BlueprintPure, Category="Actor")
 	static FVector GetLocationInFrontOfActor(AActor* Actor, float Distance);
@@ -140,6 +148,12 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Math|Random")
 	static FVector GetRandomWorldPlaneUnitVector();
 
+	/* GetRandomWorldPlaneUnitVector drawing from Stream. */
+	UFUNCTION(BlueprintPure, Category = "Math|Random")
+	static FVector GetRandomWorldPlaneUnitVectorFromStream(const FRandomStream& Stream);
+
+	static FVector GetRandomWorldPlaneUnitVector(FRancRandom& Random);
+
 	/* Given a trace and a height, find the intersection point between the trace and the plane at that height */
 	UFUNCTION(BlueprintPure, Category = "Math|Random")
 	static FVector GetIntersectionPointWithPlane(const FVector& StartPoint, const FVector& EndPoint, float PlaneZ);
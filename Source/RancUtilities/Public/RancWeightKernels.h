@@ -0,0 +1,27 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Kernels for drawing many weighted indices from one large weights array: build the inclusive prefix sums once,
+ * then every draw is a binary search over them instead of a linear cumulative scan.
+ * Negative weights count as 0 so the prefix sums never decrease.
+ */
+namespace RancWeightKernels
+{
+	/**
+	 * Writes the inclusive prefix sums of Weights into OutPrefixSums, which must have the same length.
+	 * Four lanes at a time through VectorRegister4Float, so it maps to SSE, AVX or NEON on every platform.
+	 * @return The total weight.
+	 */
+	RANCUTILITIES_API float PrefixSum(TConstArrayView<float> Weights, TArrayView<float> OutPrefixSums);
+
+	/**
+	 * Index of the first prefix sum greater than Value, i.e. the weighted index for a Value in [0, Total).
+	 * Branchless, so the loop runs exactly log2(n) times with conditional moves and no mispredictions.
+	 * Returns PrefixSums.Num() if Value is at or above the total.
+	 */
+	RANCUTILITIES_API int32 UpperBound(TConstArrayView<float> PrefixSums, float Value);
+}
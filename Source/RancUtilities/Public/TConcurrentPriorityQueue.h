@@ -0,0 +1,188 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/ScopeLock.h"
+#include "TPriorityQueue.h"
+#include <atomic>
+
+/**
+ * TConcurrentPriorityQueue lets any number of threads push prioritized work that one consumer thread drains,
+ * e.g. worker threads queueing AI replans or async loads for the game thread.
+ *
+ * Purpose:
+ * - UPriorityQueue and TIndexedPriorityQueue are single threaded. This wraps a TIndexedPriorityQueue owned by
+ *   the consumer with sharded insertion buffers for the producers.
+ *
+ * Features:
+ * - Push can be called from any thread. Each thread appends to one of several cache line aligned shards picked
+ *   by its thread id, so producers only contend when they hash to the same shard, and only for an append.
+ * - Pop, TryPop and Num are consumer only. They first move the pending shards into the heap, swapping each
+ *   shard buffer out under its lock, and rebuild the heap in O(n) when a flush is large.
+ *
+ * Ordering:
+ * - Pop returns the best element among every element whose Push returned before the Pop started.
+ *   Only pushes that are still in flight while the consumer flushes may be missed, and they are seen by the next Pop.
+ *   There is no further relaxation, so with a single consumer the queue is exact for completed pushes.
+ *
+ * Note:
+ * There must be a single consumer thread at a time. Elements are pushed without handles, so there is no decrease-key;
+ * push again with the new cost and skip stale entries when popping instead.
+ */
+template <typename ElementType, typename CostType = float, typename PredicateType = TLess<CostType>>
+class TConcurrentPriorityQueue
+{
+public:
+	/**
+	 * @param NumShards Number of producer shards, 0 picks one per hardware thread.
+	 */
+	explicit TConcurrentPriorityQueue(int32 NumShards = 0, PredicateType InPredicate = PredicateType())
+		: Heap(MoveTemp(InPredicate))
+	{
+		if (NumShards <= 0)
+		{
+			NumShards = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+		}
+
+		Shards.Reserve(NumShards);
+		for (int32 i = 0; i < FMath::Max(NumShards, 1); ++i)
+		{
+			Shards.Add(MakeUnique<FShard>());
+		}
+	}
+
+	TConcurrentPriorityQueue(const TConcurrentPriorityQueue&) = delete;
+	TConcurrentPriorityQueue& operator=(const TConcurrentPriorityQueue&) = delete;
+
+	// Thread safe
+	void Push(const ElementType& Element, CostType Cost)
+	{
+		Emplace(Cost, Element);
+	}
+
+	// Thread safe
+	void Push(ElementType&& Element, CostType Cost)
+	{
+		Emplace(Cost, MoveTemp(Element));
+	}
+
+	// Thread safe, constructs the element from Args and moves it into the shard buffer
+	template <typename... ArgsType>
+	void Emplace(CostType Cost, ArgsType&&... Args)
+	{
+		FShard& Shard = *Shards[FPlatformTLS::GetCurrentThreadId() % static_cast<uint32>(Shards.Num())];
+		{
+			FScopeLock Lock(&Shard.Lock);
+			Shard.Pending.Emplace(ElementType(Forward<ArgsType>(Args)...), Cost);
+			// Counted under the lock so a Flush that takes this element has always seen it counted
+			NumPending.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	// Consumer only
+	bool TryPop(ElementType& OutElement)
+	{
+		Flush();
+		return Heap.TryPop(OutElement);
+	}
+
+	// Consumer only
+	bool TryPop(ElementType& OutElement, CostType& OutCost)
+	{
+		Flush();
+		return Heap.TryPop(OutElement, OutCost);
+	}
+
+	/**
+	 * Consumer only. Pops up to Count elements in cost order and appends them to OutElements.
+	 * @return The number of elements popped.
+	 */
+	template <typename OutAllocatorType>
+	int32 PopMany(int32 Count, TArray<ElementType, OutAllocatorType>& OutElements)
+	{
+		Flush();
+		return Heap.PopMany(Count, OutElements);
+	}
+
+	// Consumer only, the number of elements including pending pushes
+	int32 Num()
+	{
+		Flush();
+		return Heap.Num();
+	}
+
+	// Consumer only
+	bool IsEmpty()
+	{
+		return Num() == 0;
+	}
+
+	// Safe from any thread, an estimate of how many pushes the consumer has not picked up yet
+	int32 GetNumPending() const
+	{
+		return NumPending.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Consumer only. Moves every pending push into the consumer heap, Pop and friends call this on their own.
+	 * @return The number of elements moved.
+	 */
+	int32 Flush()
+	{
+		if (NumPending.load(std::memory_order_acquire) == 0)
+		{
+			return 0;
+		}
+
+		int32 NumFlushed = 0;
+		for (const TUniquePtr<FShard>& Shard : Shards)
+		{
+			{
+				FScopeLock Lock(&Shard->Lock);
+				if (Shard->Pending.IsEmpty())
+				{
+					continue;
+				}
+				// Swap instead of copying so the lock is only held for O(1), both buffers keep their capacity
+				Swap(Shard->Pending, FlushBuffer);
+				NumPending.fetch_sub(FlushBuffer.Num(), std::memory_order_relaxed);
+			}
+
+			NumFlushed += FlushBuffer.Num();
+			const bool bRebuild = FlushBuffer.Num() > Heap.Num();
+			for (TPair<ElementType, CostType>& Pending : FlushBuffer)
+			{
+				if (bRebuild)
+				{
+					Heap.EmplaceUnordered(Pending.Value, MoveTemp(Pending.Key));
+				}
+				else
+				{
+					Heap.Push(MoveTemp(Pending.Key), Pending.Value);
+				}
+			}
+			if (bRebuild)
+			{
+				Heap.Heapify();
+			}
+			FlushBuffer.Reset();
+		}
+		return NumFlushed;
+	}
+
+private:
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FShard
+	{
+		FCriticalSection Lock;
+		TArray<TPair<ElementType, CostType>> Pending;
+	};
+
+	TArray<TUniquePtr<FShard>> Shards;
+	std::atomic<int32> NumPending{0};
+
+	// Consumer owned
+	TIndexedPriorityQueue<ElementType, CostType, PredicateType> Heap;
+	TArray<TPair<ElementType, CostType>> FlushBuffer;
+};
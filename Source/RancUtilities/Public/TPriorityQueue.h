@@ -21,6 +21,1224 @@ struct FPriorityQueueNode
 	bool operator<(const FPriorityQueueNode& Other) const;
 };
 
+/**
+ * TIndexedPriorityQueue is a native binary heap with handle based cost updates and removal.
+ *
+ * Purpose:
+ * - Give C++ callers the same fast queue that backs UPriorityQueue without a UObject allocation or GC tracking.
+ *
+ * Features:
+ * - Pluggable element, cost, predicate and allocator, e.g. TInlineAllocator<64> for small scratch searches.
+ * - Push returns a handle that stays valid until the element is popped or removed.
+ *   UpdateCost and Remove take that handle and are O(log n) sift operations.
+ * - Elements are moved in and out, so move-only types such as TUniquePtr work.
+ * - The element whose cost satisfies Predicate(Cost, Other) against all others is on top,
+ *   so TLess gives a min-queue and TGreater a max-queue.
+ *
+ * Note:
+ * This is not a UObject or USTRUCT, so it won't be accessible from Blueprints. Use UPriorityQueue there.
+ */
+template <typename ElementType, typename CostType = float, typename PredicateType = TLess<CostType>, typename AllocatorType = FDefaultAllocator>
+class TIndexedPriorityQueue
+{
+public:
+	using FHandle = int32;
+
+	explicit TIndexedPriorityQueue(PredicateType InPredicate = PredicateType())
+		: Predicate(MoveTemp(InPredicate))
+	{
+	}
+
+	TIndexedPriorityQueue(TIndexedPriorityQueue&& Other) = default;
+	TIndexedPriorityQueue& operator=(TIndexedPriorityQueue&& Other)
+	{
+		if (this != &Other)
+		{
+			Reset();
+			Entries = MoveTemp(Other.Entries);
+			Heap = MoveTemp(Other.Heap);
+			FreeHandles = MoveTemp(Other.FreeHandles);
+			Predicate = MoveTemp(Other.Predicate);
+		}
+		return *this;
+	}
+
+	TIndexedPriorityQueue(const TIndexedPriorityQueue&) = delete;
+	TIndexedPriorityQueue& operator=(const TIndexedPriorityQueue&) = delete;
+
+	~TIndexedPriorityQueue()
+	{
+		DestructLiveElements();
+	}
+
+	int32 Num() const
+	{
+		return Heap.Num();
+	}
+
+	bool IsEmpty() const
+	{
+		return Heap.IsEmpty();
+	}
+
+	void Reserve(int32 Number)
+	{
+		Entries.Reserve(Number);
+		Heap.Reserve(Number);
+	}
+
+	// Removes all elements but keeps the allocated memory for the next search
+	void Reset()
+	{
+		DestructLiveElements();
+		Entries.Reset();
+		Heap.Reset();
+		FreeHandles.Reset();
+	}
+
+	// Removes all elements and frees the memory
+	void Empty()
+	{
+		DestructLiveElements();
+		Entries.Empty();
+		Heap.Empty();
+		FreeHandles.Empty();
+	}
+
+	FHandle Push(const ElementType& Element, CostType Cost)
+	{
+		return Emplace(Cost, Element);
+	}
+
+	FHandle Push(ElementType&& Element, CostType Cost)
+	{
+		return Emplace(Cost, MoveTemp(Element));
+	}
+
+	// Constructs the element in place from Args and pushes it with Cost
+	template <typename... ArgsType>
+	FHandle Emplace(CostType Cost, ArgsType&&... Args)
+	{
+		const FHandle Handle = AllocateEntry();
+		FEntry& Entry = Entries[Handle];
+		new (Entry.Element.GetTypedPtr()) ElementType(Forward<ArgsType>(Args)...);
+		Entry.Cost = Cost;
+		Entry.HeapIndex = Heap.Add(Handle);
+		SiftUp(Entry.HeapIndex);
+		return Handle;
+	}
+
+	const ElementType& Top() const
+	{
+		check(!IsEmpty());
+		return *Entries[Heap[0]].Element.GetTypedPtr();
+	}
+
+	CostType TopCost() const
+	{
+		check(!IsEmpty());
+		return Entries[Heap[0]].Cost;
+	}
+
+	FHandle TopHandle() const
+	{
+		check(!IsEmpty());
+		return Heap[0];
+	}
+
+	ElementType Pop()
+	{
+		check(!IsEmpty());
+		return RemoveChecked(Heap[0]);
+	}
+
+	bool TryPop(ElementType& OutElement)
+	{
+		if (IsEmpty())
+		{
+			return false;
+		}
+		OutElement = RemoveChecked(Heap[0]);
+		return true;
+	}
+
+	bool TryPop(ElementType& OutElement, CostType& OutCost)
+	{
+		if (IsEmpty())
+		{
+			return false;
+		}
+		OutCost = Entries[Heap[0]].Cost;
+		OutElement = RemoveChecked(Heap[0]);
+		return true;
+	}
+
+	/**
+	 * Pops up to Count elements in cost order and appends them to OutElements.
+	 * Draining the whole queue sorts the handles once instead of sifting after every pop.
+	 * @return The number of elements popped.
+	 */
+	template <typename OutAllocatorType>
+	int32 PopMany(int32 Count, TArray<ElementType, OutAllocatorType>& OutElements)
+	{
+		Count = FMath::Clamp(Count, 0, Num());
+		OutElements.Reserve(OutElements.Num() + Count);
+
+		if (Count == Num())
+		{
+			Heap.Sort([this](const FHandle A, const FHandle B)
+			{
+				return Predicate(Entries[A].Cost, Entries[B].Cost);
+			});
+			for (const FHandle Handle : Heap)
+			{
+				ElementType* Element = Entries[Handle].Element.GetTypedPtr();
+				OutElements.Add(MoveTemp(*Element));
+				DestructItem(Element);
+			}
+			Entries.Reset();
+			Heap.Reset();
+			FreeHandles.Reset();
+			return Count;
+		}
+
+		for (int32 i = 0; i < Count; ++i)
+		{
+			OutElements.Add(RemoveChecked(Heap[0]));
+		}
+		return Count;
+	}
+
+	/**
+	 * Appends an element without restoring the heap order. Use this to seed many elements at once and call
+	 * Heapify once afterwards, which rebuilds the heap bottom-up in O(n) instead of O(n log n) for n Push calls.
+	 * Top, Pop and the other ordered operations are invalid until Heapify has been called.
+	 */
+	template <typename... ArgsType>
+	FHandle EmplaceUnordered(CostType Cost, ArgsType&&... Args)
+	{
+		const FHandle Handle = AllocateEntry();
+		FEntry& Entry = Entries[Handle];
+		new (Entry.Element.GetTypedPtr()) ElementType(Forward<ArgsType>(Args)...);
+		Entry.Cost = Cost;
+		Entry.HeapIndex = Heap.Add(Handle);
+		return Handle;
+	}
+
+	// Changes the cost of an element without restoring the heap order, see EmplaceUnordered
+	void UpdateCostUnordered(FHandle Handle, CostType NewCost)
+	{
+		check(IsValidHandle(Handle));
+		Entries[Handle].Cost = NewCost;
+	}
+
+	// Restores the heap order in O(n) (Floyd's bottom-up construction) after unordered insertions or updates
+	void Heapify()
+	{
+		for (int32 HeapIndex = Heap.Num() / 2 - 1; HeapIndex >= 0; --HeapIndex)
+		{
+			SiftDown(HeapIndex);
+		}
+	}
+
+	// Removes the element behind Handle. Does nothing if the handle is no longer valid.
+	void Remove(FHandle Handle)
+	{
+		if (IsValidHandle(Handle))
+		{
+			RemoveChecked(Handle);
+		}
+	}
+
+	// Removes the element behind Handle and returns it, the handle must be valid
+	ElementType RemoveChecked(FHandle Handle)
+	{
+		check(IsValidHandle(Handle));
+		FEntry& Entry = Entries[Handle];
+		ElementType Result = MoveTemp(*Entry.Element.GetTypedPtr());
+		DestructItem(Entry.Element.GetTypedPtr());
+
+		const int32 HeapIndex = Entry.HeapIndex;
+		const int32 LastIndex = Heap.Num() - 1;
+		Entry.HeapIndex = INDEX_NONE;
+		FreeHandles.Add(Handle);
+
+		if (HeapIndex != LastIndex)
+		{
+			// Fill the hole with the last handle and restore the heap in whichever direction it violates
+			SetHeapSlot(HeapIndex, Heap[LastIndex]);
+			Heap.Pop(EAllowShrinking::No);
+			if (SiftDown(HeapIndex) == HeapIndex)
+			{
+				SiftUp(HeapIndex);
+			}
+		}
+		else
+		{
+			Heap.Pop(EAllowShrinking::No);
+		}
+
+		return Result;
+	}
+
+	// Changes the cost of the element behind Handle, works for both decrease-key and increase-key
+	void UpdateCost(FHandle Handle, CostType NewCost)
+	{
+		check(IsValidHandle(Handle));
+		FEntry& Entry = Entries[Handle];
+		const CostType OldCost = Entry.Cost;
+		Entry.Cost = NewCost;
+
+		if (Predicate(NewCost, OldCost))
+		{
+			SiftUp(Entry.HeapIndex);
+		}
+		else if (Predicate(OldCost, NewCost))
+		{
+			SiftDown(Entry.HeapIndex);
+		}
+	}
+
+	bool IsValidHandle(FHandle Handle) const
+	{
+		return Entries.IsValidIndex(Handle) && Entries[Handle].HeapIndex != INDEX_NONE;
+	}
+
+	ElementType& Get(FHandle Handle)
+	{
+		check(IsValidHandle(Handle));
+		return *Entries[Handle].Element.GetTypedPtr();
+	}
+
+	const ElementType& Get(FHandle Handle) const
+	{
+		check(IsValidHandle(Handle));
+		return *Entries[Handle].Element.GetTypedPtr();
+	}
+
+	CostType GetCost(FHandle Handle) const
+	{
+		check(IsValidHandle(Handle));
+		return Entries[Handle].Cost;
+	}
+
+private:
+	struct FEntry
+	{
+		TTypeCompatibleBytes<ElementType> Element;
+		CostType Cost;
+		// Slot of this entry in Heap, INDEX_NONE while the entry is on the free list
+		int32 HeapIndex = INDEX_NONE;
+	};
+
+	FHandle AllocateEntry()
+	{
+		if (!FreeHandles.IsEmpty())
+		{
+			return FreeHandles.Pop(EAllowShrinking::No);
+		}
+		return Entries.AddDefaulted();
+	}
+
+	void SetHeapSlot(int32 HeapIndex, FHandle Handle)
+	{
+		Heap[HeapIndex] = Handle;
+		Entries[Handle].HeapIndex = HeapIndex;
+	}
+
+	int32 SiftUp(int32 HeapIndex)
+	{
+		const FHandle Handle = Heap[HeapIndex];
+		const CostType Cost = Entries[Handle].Cost;
+		while (HeapIndex > 0)
+		{
+			const int32 ParentIndex = (HeapIndex - 1) / 2;
+			if (!Predicate(Cost, Entries[Heap[ParentIndex]].Cost))
+			{
+				break;
+			}
+
+			// Move the parent down into the hole instead of swapping, the handle is written once at the end
+			SetHeapSlot(HeapIndex, Heap[ParentIndex]);
+			HeapIndex = ParentIndex;
+		}
+
+		SetHeapSlot(HeapIndex, Handle);
+		return HeapIndex;
+	}
+
+	int32 SiftDown(int32 HeapIndex)
+	{
+		const int32 HeapNum = Heap.Num();
+		const FHandle Handle = Heap[HeapIndex];
+		const CostType Cost = Entries[Handle].Cost;
+		while (true)
+		{
+			int32 ChildIndex = HeapIndex * 2 + 1;
+			if (ChildIndex >= HeapNum)
+			{
+				break;
+			}
+
+			if (ChildIndex + 1 < HeapNum && Predicate(Entries[Heap[ChildIndex + 1]].Cost, Entries[Heap[ChildIndex]].Cost))
+			{
+				++ChildIndex;
+			}
+
+			if (!Predicate(Entries[Heap[ChildIndex]].Cost, Cost))
+			{
+				break;
+			}
+
+			SetHeapSlot(HeapIndex, Heap[ChildIndex]);
+			HeapIndex = ChildIndex;
+		}
+
+		SetHeapSlot(HeapIndex, Handle);
+		return HeapIndex;
+	}
+
+	void DestructLiveElements()
+	{
+		if constexpr (!std::is_trivially_destructible_v<ElementType>)
+		{
+			for (const FHandle Handle : Heap)
+			{
+				DestructItem(Entries[Handle].Element.GetTypedPtr());
+			}
+		}
+	}
+
+	// Element storage indexed by handle. Freed entries are recycled through FreeHandles.
+	TArray<FEntry, AllocatorType> Entries;
+	// Binary heap of handles into Entries
+	TArray<FHandle, AllocatorType> Heap;
+	TArray<FHandle, AllocatorType> FreeHandles;
+	PredicateType Predicate;
+};
+
+/**
+ * TRadixPriorityQueue is a monotone min-queue (radix heap) for non-negative float costs.
+ *
+ * Purpose:
+ * - Dijkstra style searches over integer or quantized costs, where every pushed cost is at least the last popped cost.
+ *
+ * Features:
+ * - Same handle based Push, Pop, UpdateCost and Remove as TIndexedPriorityQueue.
+ * - Push, UpdateCost and Remove are O(1). Pop is amortized O(1): an element moves to a lower bucket at most
+ *   once per bit of its cost, so the bound is the 32 bits of the key, independent of the queue size.
+ *
+ * Note:
+ * Costs must be non-negative and not below the last popped cost, check CanAccept before pushing or updating.
+ * Non-negative floats order the same as their bit patterns, so costs are bucketed on those bits without quantizing.
+ */
+template <typename ElementType, typename AllocatorType = FDefaultAllocator>
+class TRadixPriorityQueue
+{
+public:
+	using FHandle = int32;
+
+	TRadixPriorityQueue() = default;
+
+	TRadixPriorityQueue(TRadixPriorityQueue&& Other) = default;
+	TRadixPriorityQueue& operator=(TRadixPriorityQueue&& Other)
+	{
+		if (this != &Other)
+		{
+			Reset();
+			Entries = MoveTemp(Other.Entries);
+			FreeHandles = MoveTemp(Other.FreeHandles);
+			for (int32 BucketIndex = 0; BucketIndex < NumBuckets; ++BucketIndex)
+			{
+				Buckets[BucketIndex] = MoveTemp(Other.Buckets[BucketIndex]);
+			}
+			NumElements = Other.NumElements;
+			LastKey = Other.LastKey;
+			Other.NumElements = 0;
+			Other.LastKey = 0;
+		}
+		return *this;
+	}
+
+	TRadixPriorityQueue(const TRadixPriorityQueue&) = delete;
+	TRadixPriorityQueue& operator=(const TRadixPriorityQueue&) = delete;
+
+	~TRadixPriorityQueue()
+	{
+		DestructLiveElements();
+	}
+
+	int32 Num() const
+	{
+		return NumElements;
+	}
+
+	bool IsEmpty() const
+	{
+		return NumElements == 0;
+	}
+
+	void Reserve(int32 Number)
+	{
+		Entries.Reserve(Number);
+	}
+
+	// Removes all elements but keeps the allocated memory for the next search
+	void Reset()
+	{
+		DestructLiveElements();
+		Entries.Reset();
+		FreeHandles.Reset();
+		for (TArray<FHandle, AllocatorType>& Bucket : Buckets)
+		{
+			Bucket.Reset();
+		}
+		NumElements = 0;
+		LastKey = 0;
+	}
+
+	// Removes all elements and frees the memory
+	void Empty()
+	{
+		Reset();
+		Entries.Empty();
+		FreeHandles.Empty();
+		for (TArray<FHandle, AllocatorType>& Bucket : Buckets)
+		{
+			Bucket.Empty();
+		}
+	}
+
+	// Whether Cost keeps the queue monotone, i.e. it is non-negative and not below the last popped cost
+	bool CanAccept(float Cost) const
+	{
+		// Written so NaN is rejected as well
+		if (!(Cost >= 0.f))
+		{
+			return false;
+		}
+		return IsEmpty() || ToKey(Cost) >= LastKey;
+	}
+
+	FHandle Push(const ElementType& Element, float Cost)
+	{
+		return Emplace(Cost, Element);
+	}
+
+	FHandle Push(ElementType&& Element, float Cost)
+	{
+		return Emplace(Cost, MoveTemp(Element));
+	}
+
+	template <typename... ArgsType>
+	FHandle Emplace(float Cost, ArgsType&&... Args)
+	{
+		check(CanAccept(Cost));
+		const uint32 Key = ToKey(Cost);
+		if (IsEmpty() && Key < LastKey)
+		{
+			// Nothing is queued, so the monotone floor can safely restart below the last pop
+			LastKey = 0;
+		}
+
+		FHandle Handle;
+		if (!FreeHandles.IsEmpty())
+		{
+			Handle = FreeHandles.Pop(EAllowShrinking::No);
+		}
+		else
+		{
+			Handle = Entries.AddDefaulted();
+		}
+
+		FEntry& Entry = Entries[Handle];
+		new (Entry.Element.GetTypedPtr()) ElementType(Forward<ArgsType>(Args)...);
+		Entry.Cost = Cost;
+		Entry.Key = Key;
+		AddToBucket(Handle);
+		++NumElements;
+		return Handle;
+	}
+
+	// Not const, finding the minimum may redistribute a bucket
+	const ElementType& Top()
+	{
+		check(!IsEmpty());
+		PrepareMinBucket();
+		return *Entries[Buckets[0].Last()].Element.GetTypedPtr();
+	}
+
+	float TopCost()
+	{
+		check(!IsEmpty());
+		PrepareMinBucket();
+		return Entries[Buckets[0].Last()].Cost;
+	}
+
+	ElementType Pop()
+	{
+		check(!IsEmpty());
+		PrepareMinBucket();
+		return RemoveChecked(Buckets[0].Last());
+	}
+
+	bool TryPop(ElementType& OutElement, float& OutCost)
+	{
+		if (IsEmpty())
+		{
+			return false;
+		}
+		PrepareMinBucket();
+		const FHandle Handle = Buckets[0].Last();
+		OutCost = Entries[Handle].Cost;
+		OutElement = RemoveChecked(Handle);
+		return true;
+	}
+
+	// Removes the element behind Handle. Does nothing if the handle is no longer valid.
+	void Remove(FHandle Handle)
+	{
+		if (IsValidHandle(Handle))
+		{
+			RemoveChecked(Handle);
+		}
+	}
+
+	// Removes the element behind Handle and returns it, the handle must be valid
+	ElementType RemoveChecked(FHandle Handle)
+	{
+		check(IsValidHandle(Handle));
+		RemoveFromBucket(Handle);
+		ElementType* Element = Entries[Handle].Element.GetTypedPtr();
+		ElementType Result = MoveTemp(*Element);
+		DestructItem(Element);
+		FreeHandles.Add(Handle);
+		--NumElements;
+		return Result;
+	}
+
+	// Changes the cost of the element behind Handle. The new cost must pass CanAccept.
+	void UpdateCost(FHandle Handle, float NewCost)
+	{
+		check(IsValidHandle(Handle));
+		check(CanAccept(NewCost));
+		RemoveFromBucket(Handle);
+		FEntry& Entry = Entries[Handle];
+		Entry.Cost = NewCost;
+		Entry.Key = ToKey(NewCost);
+		AddToBucket(Handle);
+	}
+
+	bool IsValidHandle(FHandle Handle) const
+	{
+		return Entries.IsValidIndex(Handle) && Entries[Handle].Bucket != INDEX_NONE;
+	}
+
+	const ElementType& Get(FHandle Handle) const
+	{
+		check(IsValidHandle(Handle));
+		return *Entries[Handle].Element.GetTypedPtr();
+	}
+
+	float GetCost(FHandle Handle) const
+	{
+		check(IsValidHandle(Handle));
+		return Entries[Handle].Cost;
+	}
+
+	// Moves every element out in no particular order, calling Func(ElementType&&, float Cost) for each, then resets the queue
+	template <typename FuncType>
+	void DrainUnordered(FuncType&& Func)
+	{
+		for (const TArray<FHandle, AllocatorType>& Bucket : Buckets)
+		{
+			for (const FHandle Handle : Bucket)
+			{
+				FEntry& Entry = Entries[Handle];
+				ElementType* Element = Entry.Element.GetTypedPtr();
+				Func(MoveTemp(*Element), Entry.Cost);
+				DestructItem(Element);
+			}
+		}
+		// The elements are already destroyed, so empty the buckets before Reset walks them
+		for (TArray<FHandle, AllocatorType>& Bucket : Buckets)
+		{
+			Bucket.Reset();
+		}
+		Reset();
+	}
+
+private:
+	// Bucket 0 holds keys equal to LastKey, bucket i holds keys whose highest bit differing from LastKey is bit i - 1
+	static constexpr int32 NumBuckets = 33;
+
+	struct FEntry
+	{
+		TTypeCompatibleBytes<ElementType> Element;
+		float Cost;
+		uint32 Key;
+		// INDEX_NONE while the entry is on the free list
+		int32 Bucket = INDEX_NONE;
+		int32 BucketSlot = INDEX_NONE;
+	};
+
+	static uint32 ToKey(float Cost)
+	{
+		// Also folds -0.0 onto 0
+		if (Cost <= 0.f)
+		{
+			return 0;
+		}
+		uint32 Key;
+		FMemory::Memcpy(&Key, &Cost, sizeof(Key));
+		return Key;
+	}
+
+	int32 BucketFor(uint32 Key) const
+	{
+		return Key == LastKey ? 0 : 32 - static_cast<int32>(FMath::CountLeadingZeros(Key ^ LastKey));
+	}
+
+	void AddToBucket(FHandle Handle)
+	{
+		FEntry& Entry = Entries[Handle];
+		Entry.Bucket = BucketFor(Entry.Key);
+		Entry.BucketSlot = Buckets[Entry.Bucket].Add(Handle);
+	}
+
+	void RemoveFromBucket(FHandle Handle)
+	{
+		FEntry& Entry = Entries[Handle];
+		TArray<FHandle, AllocatorType>& Bucket = Buckets[Entry.Bucket];
+		const FHandle MovedHandle = Bucket.Last();
+		Bucket[Entry.BucketSlot] = MovedHandle;
+		Entries[MovedHandle].BucketSlot = Entry.BucketSlot;
+		Bucket.Pop(EAllowShrinking::No);
+		Entry.Bucket = INDEX_NONE;
+		Entry.BucketSlot = INDEX_NONE;
+	}
+
+	// Makes sure bucket 0 holds the current minimum by raising LastKey and redistributing the first non-empty bucket
+	void PrepareMinBucket()
+	{
+		if (!Buckets[0].IsEmpty())
+		{
+			return;
+		}
+
+		int32 SourceIndex = 1;
+		while (Buckets[SourceIndex].IsEmpty())
+		{
+			++SourceIndex;
+		}
+
+		TArray<FHandle, AllocatorType>& Source = Buckets[SourceIndex];
+		uint32 MinKey = MAX_uint32;
+		for (const FHandle Handle : Source)
+		{
+			MinKey = FMath::Min(MinKey, Entries[Handle].Key);
+		}
+
+		// Every element of the source bucket lands in a strictly lower bucket relative to the new minimum,
+		// and elements in higher buckets keep their bucket since their differing bit is above the change
+		LastKey = MinKey;
+		for (const FHandle Handle : Source)
+		{
+			AddToBucket(Handle);
+		}
+		Source.Reset();
+	}
+
+	void DestructLiveElements()
+	{
+		if constexpr (!std::is_trivially_destructible_v<ElementType>)
+		{
+			for (const TArray<FHandle, AllocatorType>& Bucket : Buckets)
+			{
+				for (const FHandle Handle : Bucket)
+				{
+					DestructItem(Entries[Handle].Element.GetTypedPtr());
+				}
+			}
+		}
+	}
+
+	TArray<FEntry, AllocatorType> Entries;
+	TArray<FHandle, AllocatorType> FreeHandles;
+	TArray<FHandle, AllocatorType> Buckets[NumBuckets];
+	int32 NumElements = 0;
+	// Key of the last popped minimum, every queued key is at least this
+	uint32 LastKey = 0;
+};
+
+/**
+ * TMinMaxPriorityQueue is a native min-max heap with handles, so both the best and the worst element can be
+ * read and popped in O(log n). With a max size it becomes a bounded top-K queue.
+ *
+ * Purpose:
+ * - Keep only the best K candidates out of many scored ones, e.g. the 16 best targets out of 5000,
+ *   so memory and work stay proportional to K instead of the number of candidates.
+ *
+ * Features:
+ * - Same handle based Push, Pop, UpdateCost and Remove as TIndexedPriorityQueue, plus Bottom and PopBottom.
+ * - SetMaxNum caps the size. Pushing into a full queue evicts the worst element in O(log K),
+ *   or rejects the new element and returns INDEX_NONE if it is not better than the worst one.
+ * - Even levels are ordered by Predicate and odd levels by its reverse, so the best element is the root
+ *   and the worst is one of its two children.
+ */
+template <typename ElementType, typename CostType = float, typename PredicateType = TLess<CostType>, typename AllocatorType = FDefaultAllocator>
+class TMinMaxPriorityQueue
+{
+public:
+	using FHandle = int32;
+
+	explicit TMinMaxPriorityQueue(int32 InMaxNum = 0, PredicateType InPredicate = PredicateType())
+		: Predicate(MoveTemp(InPredicate))
+		, MaxNum(FMath::Max(InMaxNum, 0))
+	{
+	}
+
+	TMinMaxPriorityQueue(TMinMaxPriorityQueue&& Other) = default;
+	TMinMaxPriorityQueue& operator=(TMinMaxPriorityQueue&& Other)
+	{
+		if (this != &Other)
+		{
+			Reset();
+			Entries = MoveTemp(Other.Entries);
+			Heap = MoveTemp(Other.Heap);
+			FreeHandles = MoveTemp(Other.FreeHandles);
+			Predicate = MoveTemp(Other.Predicate);
+			MaxNum = Other.MaxNum;
+		}
+		return *this;
+	}
+
+	TMinMaxPriorityQueue(const TMinMaxPriorityQueue&) = delete;
+	TMinMaxPriorityQueue& operator=(const TMinMaxPriorityQueue&) = delete;
+
+	~TMinMaxPriorityQueue()
+	{
+		DestructLiveElements();
+	}
+
+	int32 Num() const
+	{
+		return Heap.Num();
+	}
+
+	bool IsEmpty() const
+	{
+		return Heap.IsEmpty();
+	}
+
+	// Whether the next push has to evict or be rejected
+	bool IsFull() const
+	{
+		return MaxNum > 0 && Heap.Num() >= MaxNum;
+	}
+
+	int32 GetMaxNum() const
+	{
+		return MaxNum;
+	}
+
+	// Caps the queue at NewMaxNum elements, 0 removes the cap. Shrinking evicts the worst elements.
+	void SetMaxNum(int32 NewMaxNum)
+	{
+		MaxNum = FMath::Max(NewMaxNum, 0);
+		while (MaxNum > 0 && Heap.Num() > MaxNum)
+		{
+			RemoveChecked(BottomHandle());
+		}
+	}
+
+	void Reserve(int32 Number)
+	{
+		Entries.Reserve(Number);
+		Heap.Reserve(Number);
+	}
+
+	// Removes all elements but keeps the allocated memory
+	void Reset()
+	{
+		DestructLiveElements();
+		Entries.Reset();
+		Heap.Reset();
+		FreeHandles.Reset();
+	}
+
+	// Removes all elements and frees the memory
+	void Empty()
+	{
+		DestructLiveElements();
+		Entries.Empty();
+		Heap.Empty();
+		FreeHandles.Empty();
+	}
+
+	// Whether an element with Cost would be kept, i.e. the queue has room or Cost beats the current worst
+	bool WouldAccept(CostType Cost) const
+	{
+		return !IsFull() || Predicate(Cost, BottomCost());
+	}
+
+	FHandle Push(const ElementType& Element, CostType Cost)
+	{
+		return Emplace(Cost, Element);
+	}
+
+	FHandle Push(ElementType&& Element, CostType Cost)
+	{
+		return Emplace(Cost, MoveTemp(Element));
+	}
+
+	/**
+	 * Constructs the element in place from Args and pushes it with Cost. A full queue evicts its worst element first.
+	 * @return The handle of the new element, or INDEX_NONE if the queue is full and Cost is not better than the worst.
+	 */
+	template <typename... ArgsType>
+	FHandle Emplace(CostType Cost, ArgsType&&... Args)
+	{
+		if (IsFull())
+		{
+			if (!Predicate(Cost, BottomCost()))
+			{
+				return INDEX_NONE;
+			}
+			RemoveChecked(BottomHandle());
+		}
+
+		FHandle Handle;
+		if (!FreeHandles.IsEmpty())
+		{
+			Handle = FreeHandles.Pop(EAllowShrinking::No);
+		}
+		else
+		{
+			Handle = Entries.AddDefaulted();
+		}
+
+		FEntry& Entry = Entries[Handle];
+		new (Entry.Element.GetTypedPtr()) ElementType(Forward<ArgsType>(Args)...);
+		Entry.Cost = Cost;
+		Entry.HeapIndex = Heap.Add(Handle);
+		SiftUp(Entry.HeapIndex);
+		return Handle;
+	}
+
+	const ElementType& Top() const
+	{
+		check(!IsEmpty());
+		return *Entries[Heap[0]].Element.GetTypedPtr();
+	}
+
+	CostType TopCost() const
+	{
+		check(!IsEmpty());
+		return Entries[Heap[0]].Cost;
+	}
+
+	FHandle TopHandle() const
+	{
+		check(!IsEmpty());
+		return Heap[0];
+	}
+
+	// The worst element, i.e. the one a full queue evicts next
+	const ElementType& Bottom() const
+	{
+		return *Entries[BottomHandle()].Element.GetTypedPtr();
+	}
+
+	CostType BottomCost() const
+	{
+		return Entries[BottomHandle()].Cost;
+	}
+
+	FHandle BottomHandle() const
+	{
+		check(!IsEmpty());
+		if (Heap.Num() <= 2)
+		{
+			return Heap.Last();
+		}
+		return Predicate(Entries[Heap[1]].Cost, Entries[Heap[2]].Cost) ? Heap[2] : Heap[1];
+	}
+
+	ElementType Pop()
+	{
+		check(!IsEmpty());
+		return RemoveChecked(Heap[0]);
+	}
+
+	bool TryPop(ElementType& OutElement, CostType& OutCost)
+	{
+		if (IsEmpty())
+		{
+			return false;
+		}
+		OutCost = Entries[Heap[0]].Cost;
+		OutElement = RemoveChecked(Heap[0]);
+		return true;
+	}
+
+	ElementType PopBottom()
+	{
+		return RemoveChecked(BottomHandle());
+	}
+
+	bool TryPopBottom(ElementType& OutElement, CostType& OutCost)
+	{
+		if (IsEmpty())
+		{
+			return false;
+		}
+		const FHandle Handle = BottomHandle();
+		OutCost = Entries[Handle].Cost;
+		OutElement = RemoveChecked(Handle);
+		return true;
+	}
+
+	// Removes the element behind Handle. Does nothing if the handle is no longer valid.
+	void Remove(FHandle Handle)
+	{
+		if (IsValidHandle(Handle))
+		{
+			RemoveChecked(Handle);
+		}
+	}
+
+	// Removes the element behind Handle and returns it, the handle must be valid
+	ElementType RemoveChecked(FHandle Handle)
+	{
+		check(IsValidHandle(Handle));
+		FEntry& Entry = Entries[Handle];
+		ElementType Result = MoveTemp(*Entry.Element.GetTypedPtr());
+		DestructItem(Entry.Element.GetTypedPtr());
+
+		const int32 HeapIndex = Entry.HeapIndex;
+		const int32 LastIndex = Heap.Num() - 1;
+		Entry.HeapIndex = INDEX_NONE;
+		FreeHandles.Add(Handle);
+
+		if (HeapIndex != LastIndex)
+		{
+			SetHeapSlot(HeapIndex, Heap[LastIndex]);
+			Heap.Pop(EAllowShrinking::No);
+			Restore(HeapIndex);
+		}
+		else
+		{
+			Heap.Pop(EAllowShrinking::No);
+		}
+
+		return Result;
+	}
+
+	// Changes the cost of the element behind Handle in O(log n), in either direction
+	void UpdateCost(FHandle Handle, CostType NewCost)
+	{
+		check(IsValidHandle(Handle));
+		Entries[Handle].Cost = NewCost;
+		Restore(Entries[Handle].HeapIndex);
+	}
+
+	bool IsValidHandle(FHandle Handle) const
+	{
+		return Entries.IsValidIndex(Handle) && Entries[Handle].HeapIndex != INDEX_NONE;
+	}
+
+	const ElementType& Get(FHandle Handle) const
+	{
+		check(IsValidHandle(Handle));
+		return *Entries[Handle].Element.GetTypedPtr();
+	}
+
+	CostType GetCost(FHandle Handle) const
+	{
+		check(IsValidHandle(Handle));
+		return Entries[Handle].Cost;
+	}
+
+	// Moves every element out in no particular order, calling Func(ElementType&&, CostType) for each, then resets the queue
+	template <typename FuncType>
+	void DrainUnordered(FuncType&& Func)
+	{
+		for (const FHandle Handle : Heap)
+		{
+			FEntry& Entry = Entries[Handle];
+			ElementType* Element = Entry.Element.GetTypedPtr();
+			Func(MoveTemp(*Element), Entry.Cost);
+			DestructItem(Element);
+		}
+		Heap.Reset();
+		Reset();
+	}
+
+private:
+	struct FEntry
+	{
+		TTypeCompatibleBytes<ElementType> Element;
+		CostType Cost;
+		// Slot of this entry in Heap, INDEX_NONE while the entry is on the free list
+		int32 HeapIndex = INDEX_NONE;
+	};
+
+	// Levels 0, 2, 4... hold the best element of their subtree, levels 1, 3, 5... the worst
+	static bool IsBestLevel(int32 HeapIndex)
+	{
+		return (FMath::FloorLog2(static_cast<uint32>(HeapIndex + 1)) & 1) == 0;
+	}
+
+	// Whether A belongs above B on a level of the given kind
+	bool Outranks(int32 HeapIndexA, int32 HeapIndexB, bool bBestLevel) const
+	{
+		const CostType CostA = Entries[Heap[HeapIndexA]].Cost;
+		const CostType CostB = Entries[Heap[HeapIndexB]].Cost;
+		return bBestLevel ? Predicate(CostA, CostB) : Predicate(CostB, CostA);
+	}
+
+	void SetHeapSlot(int32 HeapIndex, FHandle Handle)
+	{
+		Heap[HeapIndex] = Handle;
+		Entries[Handle].HeapIndex = HeapIndex;
+	}
+
+	void SwapHeapSlots(int32 HeapIndexA, int32 HeapIndexB)
+	{
+		const FHandle HandleA = Heap[HeapIndexA];
+		SetHeapSlot(HeapIndexA, Heap[HeapIndexB]);
+		SetHeapSlot(HeapIndexB, HandleA);
+	}
+
+	// Re-establishes the order around a slot whose element changed. Sifting down first means the element can only
+	// swap with its parent afterwards when it has no descendants left that the parent would then violate.
+	void Restore(int32 HeapIndex)
+	{
+		const FHandle Handle = Heap[HeapIndex];
+		SiftDown(HeapIndex);
+		SiftUp(Entries[Handle].HeapIndex);
+	}
+
+	void SiftUp(int32 HeapIndex)
+	{
+		if (HeapIndex == 0)
+		{
+			return;
+		}
+
+		const bool bBestLevel = IsBestLevel(HeapIndex);
+		const int32 ParentIndex = (HeapIndex - 1) / 2;
+		if (Outranks(ParentIndex, HeapIndex, bBestLevel))
+		{
+			// The element belongs on the other kind of level, continue along the parent's grandparent chain
+			SwapHeapSlots(HeapIndex, ParentIndex);
+			SiftUpAlongLevels(ParentIndex, !bBestLevel);
+		}
+		else
+		{
+			SiftUpAlongLevels(HeapIndex, bBestLevel);
+		}
+	}
+
+	void SiftUpAlongLevels(int32 HeapIndex, bool bBestLevel)
+	{
+		while (HeapIndex >= 3)
+		{
+			const int32 GrandparentIndex = ((HeapIndex - 1) / 2 - 1) / 2;
+			if (!Outranks(HeapIndex, GrandparentIndex, bBestLevel))
+			{
+				break;
+			}
+			SwapHeapSlots(HeapIndex, GrandparentIndex);
+			HeapIndex = GrandparentIndex;
+		}
+	}
+
+	void SiftDown(int32 HeapIndex)
+	{
+		const bool bBestLevel = IsBestLevel(HeapIndex);
+		const int32 HeapNum = Heap.Num();
+		while (true)
+		{
+			const int32 FirstChild = HeapIndex * 2 + 1;
+			if (FirstChild >= HeapNum)
+			{
+				return;
+			}
+
+			// Find the most extreme of the up to two children and four grandchildren
+			int32 ExtremeIndex = FirstChild;
+			const int32 Candidates[] = { FirstChild + 1, FirstChild * 2 + 1, FirstChild * 2 + 2, FirstChild * 2 + 3, FirstChild * 2 + 4 };
+			for (const int32 Candidate : Candidates)
+			{
+				if (Candidate < HeapNum && Outranks(Candidate, ExtremeIndex, bBestLevel))
+				{
+					ExtremeIndex = Candidate;
+				}
+			}
+
+			if (ExtremeIndex <= FirstChild + 1)
+			{
+				if (Outranks(ExtremeIndex, HeapIndex, bBestLevel))
+				{
+					SwapHeapSlots(ExtremeIndex, HeapIndex);
+				}
+				return;
+			}
+
+			if (!Outranks(ExtremeIndex, HeapIndex, bBestLevel))
+			{
+				return;
+			}
+			SwapHeapSlots(ExtremeIndex, HeapIndex);
+
+			const int32 ParentIndex = (ExtremeIndex - 1) / 2;
+			if (Outranks(ParentIndex, ExtremeIndex, bBestLevel))
+			{
+				SwapHeapSlots(ExtremeIndex, ParentIndex);
+			}
+			HeapIndex = ExtremeIndex;
+		}
+	}
+
+	void DestructLiveElements()
+	{
+		if constexpr (!std::is_trivially_destructible_v<ElementType>)
+		{
+			for (const FHandle Handle : Heap)
+			{
+				DestructItem(Entries[Handle].Element.GetTypedPtr());
+			}
+		}
+	}
+
+	TArray<FEntry, AllocatorType> Entries;
+	// Min-max heap of handles into Entries
+	TArray<FHandle, AllocatorType> Heap;
+	TArray<FHandle, AllocatorType> FreeHandles;
+	PredicateType Predicate;
+	// 0 means unbounded
+	int32 MaxNum = 0;
+};
+
+UENUM(BlueprintType)
+enum class EPriorityQueueMode : uint8
+{
+	// General purpose binary heap, any cost order is allowed
+	BinaryHeap UMETA(DisplayName = "Binary Heap"),
+	// Radix heap for non-negative costs that never go below the last popped cost, e.g. Dijkstra over grid costs.
+	// Falls back to the binary heap while that assumption is broken.
+	Monotone UMETA(DisplayName = "Monotone"),
+	// Min-max heap that keeps only the MaxSize cheapest elements and can peek and pop the most expensive one
+	Bounded UMETA(DisplayName = "Bounded Top-K")
+};
+
+/**
+ * UPriorityQueue is a Blueprint friendly min-queue of integers ordered by float cost.
+ * It is a thin wrapper over TIndexedPriorityQueue (TRadixPriorityQueue in Monotone mode,
+ * TMinMaxPriorityQueue in Bounded mode), mapping each DataInteger to its queue handle.
+ */
 UCLASS(Blueprintable, EditInlineNew)
 class UPriorityQueue : public UObject
 {
@@ -31,29 +1249,89 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
 	void SetInitialCapacity(int InitialCapacity);
+
+	// Switches the queue implementation. Queued elements are kept.
+	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
+	void SetMode(EPriorityQueueMode NewMode);
 	
+	/**
+	 * Sets how many elements Bounded mode keeps, 0 or less keeps everything.
+	 * Pushing into a full queue drops the most expensive element, or the pushed one if it is not cheaper.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
+	void SetMaxSize(int32 NewMaxSize);
+
 	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
 	void Clear();
 
 	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
 	int Pop(bool& Success);
 
+	// Pushes DataInteger with the given cost. If DataInteger is already queued its cost is updated instead.
 	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
 	void Push(int DataInteger, float Cost);
 	
+	// Removes DataInteger from the queue in O(log n). Does nothing if it is not queued.
 	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
 	void Remove(int DataInteger);
 
+	// Changes the cost of a queued DataInteger in O(log n), works for both decrease-key and increase-key.
 	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
 	void Replace(int DataInteger, float NewCost);
 	
+	/**
+	 * Pushes many DataIntegers at once. Data and Costs must have the same length.
+	 * Already queued DataIntegers get their cost updated. Large batches are appended and heapified in one O(n) pass.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
+	void PushBatch(const TArray<int>& Data, const TArray<float>& Costs);
+
+	// Clears the queue and fills it from Data and Costs in one O(n) pass
+	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
+	void BuildFromArrays(const TArray<int>& Data, const TArray<float>& Costs);
+
+	// Pops up to Count DataIntegers in cost order, cheapest first
+	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
+	TArray<int> PopBatch(int32 Count);
+
+	// Returns the cheapest DataInteger without removing it
+	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
+	int PeekBest(bool& Success, float& Cost);
+
+	// Returns the most expensive DataInteger without removing it. Only available in Bounded mode.
+	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
+	int PeekWorst(bool& Success, float& Cost);
+
+	// Pops the most expensive DataInteger. Only available in Bounded mode.
+	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
+	int PopWorst(bool& Success);
+
 	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
 	bool Contains(int DataInteger);
 
 	UFUNCTION(BlueprintCallable, Category = "PriorityQueue")
 	bool IsEmpty() const;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PriorityQueue")
+	EPriorityQueueMode Mode = EPriorityQueueMode::BinaryHeap;
+
+	// Capacity K of Bounded mode, see SetMaxSize
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PriorityQueue")
+	int32 MaxSize = 16;
+
 private:
-	TArray<FPriorityQueueNode> Array;
-	TSet<int> ContainsSet;
+	// Whether the radix queue is in use, clears a monotone fallback once the binary heap has drained
+	bool UseRadixQueue();
+	// Moves everything from the radix queue into the binary heap after a non-monotone cost was seen
+	void FallBackToBinaryHeap();
+	// Drops the most expensive elements of BoundedQueue until at most Capacity are left
+	void TrimBoundedQueue(int32 Capacity);
+
+	TIndexedPriorityQueue<int, float> Queue;
+	TRadixPriorityQueue<int> RadixQueue;
+	TMinMaxPriorityQueue<int, float> BoundedQueue;
+	// Set in Monotone mode while the binary heap is used because a cost broke the monotone assumption
+	bool bMonotoneFallback = false;
+	// Maps each queued DataInteger to its handle in Queue, so updates and removals can sift in place
+	TMap<int, int32> HandleMap;
 };
\ No newline at end of file
@@ -0,0 +1,154 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "RancRandom.h"
+#include "WeightedRandomSelector.h"
+#include "WeightedAliasTable.generated.h"
+
+/**
+ * FWeightedAliasTable is a weighted index sampler built once with Vose's alias method, after which every draw is O(1):
+ * one uniform column pick and one coin flip, instead of the O(n) sum and scan of UWeightedRandomSelector.
+ *
+ * Weights follow UWeightedRandomSelector: if every weight is 0 the indices are uniform.
+ * Negative weights count as 0.
+ */
+USTRUCT(BlueprintType)
+struct RANCUTILITIES_API FWeightedAliasTable
+{
+	GENERATED_BODY()
+
+	// Rebuilds the table in O(n)
+	void Build(TConstArrayView<float> Weights);
+
+	int32 Num() const { return Probabilities.Num(); }
+	bool IsEmpty() const { return Probabilities.IsEmpty(); }
+
+	// Draws a weighted index, INDEX_NONE if the table is empty
+	int32 Sample() const;
+
+	// Appends Count weighted indices to OutIndices
+	void SampleMany(int32 Count, TArray<int32>& OutIndices) const;
+
+	// Draws from Random, any generator with the FRandomStream calls such as FRancRandom or FRandomStream
+	template <typename RandomType>
+	int32 Sample(RandomType& Random) const
+	{
+		if (IsEmpty())
+		{
+			return INDEX_NONE;
+		}
+
+		const int32 Column = Random.RandHelper(Probabilities.Num());
+		return Random.FRand() < Probabilities[Column] ? Column : Aliases[Column];
+	}
+
+	template <typename RandomType>
+	void SampleMany(RandomType& Random, int32 Count, TArray<int32>& OutIndices) const
+	{
+		if (IsEmpty() || Count <= 0)
+		{
+			return;
+		}
+
+		OutIndices.Reserve(OutIndices.Num() + Count);
+		for (int32 i = 0; i < Count; ++i)
+		{
+			OutIndices.Add(Sample(Random));
+		}
+	}
+
+private:
+	// Chance of keeping the column index rather than taking its alias, per column
+	UPROPERTY()
+	TArray<float> Probabilities;
+
+	UPROPERTY()
+	TArray<int32> Aliases;
+};
+
+/**
+ * UWeightedAliasTable wraps FWeightedAliasTable for Blueprints. Build it once from a loot table or a weights array,
+ * then roll it as often as needed in O(1) per roll.
+ */
+UCLASS(BlueprintType)
+class RANCUTILITIES_API UWeightedAliasTable : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	// Creates a table sampling indices into Weights
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static UWeightedAliasTable* CreateWeightedAliasTable(UObject* Outer, const TArray<float>& Weights);
+
+	// Creates a table sampling the items, SampleItem returns them directly
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static UWeightedAliasTable* CreateWeightedAliasTableFromItems(UObject* Outer, const TArray<FSWeightedItem>& Items);
+
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	void BuildFromWeights(const TArray<float>& Weights);
+
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	void BuildFromItems(const TArray<FSWeightedItem>& InItems);
+
+	// Draws a weighted index, -1 if the table is empty
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	int SampleIndex() const;
+
+	// SampleIndex drawing from Stream
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	int SampleIndexFromStream(const FRandomStream& Stream) const;
+
+	int SampleIndex(FRancRandom& Random) const;
+
+	// Draws a weighted item, null if the table was built from weights only or is empty
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	UObject* SampleItem() const;
+
+	// SampleItem drawing from Stream
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	UObject* SampleItemFromStream(const FRandomStream& Stream) const;
+
+	UObject* SampleItem(FRancRandom& Random) const;
+
+	// Draws Count weighted indices
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	TArray<int> SampleMany(int32 Count) const;
+
+	// SampleMany drawing from Stream
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	TArray<int> SampleManyFromStream(const FRandomStream& Stream, int32 Count) const;
+
+	TArray<int> SampleMany(FRancRandom& Random, int32 Count) const;
+
+	// Draws Count weighted items, see SampleItem
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	TArray<UObject*> SampleManyItems(int32 Count) const;
+
+	// SampleManyItems drawing from Stream
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	TArray<UObject*> SampleManyItemsFromStream(const FRandomStream& Stream, int32 Count) const;
+
+	TArray<UObject*> SampleManyItems(FRancRandom& Random, int32 Count) const;
+
+	UFUNCTION(BlueprintPure, Category = "WeightedRandomSelector")
+	int32 Num() const { return Table.Num(); }
+
+	const FWeightedAliasTable& GetTable() const { return Table; }
+
+private:
+	template <typename RandomType>
+	UObject* SampleItemWith(RandomType& Random) const;
+
+	template <typename RandomType>
+	TArray<UObject*> SampleManyItemsWith(RandomType& Random, int32 Count) const;
+
+	UPROPERTY()
+	FWeightedAliasTable Table;
+
+	// Empty when built from weights only
+	UPROPERTY()
+	TArray<UObject*> Items;
+};
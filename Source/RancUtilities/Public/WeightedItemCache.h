@@ -0,0 +1,67 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "DynamicWeightedSampler.h"
+#include "WeightedRandomSelector.h"
+#include "WeightedItemCache.generated.h"
+
+/**
+ * UWeightedItemCache remembers the IWeightedItem weights of a fixed set of items so selecting from them
+ * does not call GetWeight at all, which matters when the weights are implemented in Blueprint.
+ *
+ * Weights are read once when the items are set and again only for items that were invalidated.
+ * The cached weights live in an FWeightedSumTree, so a selection and each refreshed weight cost O(log n).
+ */
+UCLASS(BlueprintType)
+class RANCUTILITIES_API UWeightedItemCache : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static UWeightedItemCache* CreateWeightedItemCache(UObject* Outer, const TArray<TScriptInterface<IWeightedItem>>& Items);
+
+	// Replaces the cached items and reads each weight once
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	void SetItems(const TArray<TScriptInterface<IWeightedItem>>& InItems);
+
+	// Marks the weight of Item as stale, it is read again before the next selection.
+	// An item listed several times has every one of its entries refreshed.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	void InvalidateItem(const TScriptInterface<IWeightedItem>& Item);
+
+	// Marks every weight as stale
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	void InvalidateAll();
+
+	// Selects a random item weighted by its cached weight. All weights 0 gives an equal chance, null if empty.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	TScriptInterface<IWeightedItem> SelectRandomItem();
+
+	// SelectRandomItem drawing from Stream
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	TScriptInterface<IWeightedItem> SelectRandomItemFromStream(const FRandomStream& Stream);
+
+	TScriptInterface<IWeightedItem> SelectRandomItem(FRancRandom& Random);
+
+	UFUNCTION(BlueprintPure, Category = "WeightedRandomSelector")
+	const TArray<TScriptInterface<IWeightedItem>>& GetItems() const { return Items; }
+
+private:
+	// Reads the weights of the invalidated items
+	void RefreshWeights();
+
+	void MarkStale(int32 Index);
+
+	UPROPERTY()
+	TArray<TScriptInterface<IWeightedItem>> Items;
+
+	// Every index of each item, an item may be listed more than once to raise its odds
+	TMultiMap<const UObject*, int32> ItemIndices;
+	TArray<int32> StaleIndices;
+	TBitArray<> StaleMask;
+	FWeightedSumTree Weights;
+};
@@ -6,11 +6,18 @@
 #include "Engine/DataTable.h"
 #include "UObject/Interface.h"
 #include "GameFramework/Actor.h"
+#include "RancRandom.h"
 #include "WeightedRandomSelector.generated.h"
 
 // Delegate to get the weight of an item at a specified index
 DECLARE_DYNAMIC_DELEGATE_RetVal_OneParam(float, FGetWeightDelegate, int, ItemIndex);
 
+// Delegate to get the weights of all items in one call, must return ItemCount weights
+DECLARE_DYNAMIC_DELEGATE_RetVal_OneParam(TArray<float>, FGetWeightsDelegate, int, ItemCount);
+
+// Delegate to get the weight of an actor
+DECLARE_DYNAMIC_DELEGATE_RetVal_OneParam(float, FGetActorWeightDelegate, AActor*, Actor);
+
 USTRUCT(BlueprintType)
 struct FSWeightedItem
 {
@@ -52,11 +59,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
 	static UObject* SelectRandomWeightedItem(const TArray<FSWeightedItem>& Items);
 
+	// SelectRandomWeightedItem drawing from Stream, the same seed gives the same picks.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static UObject* SelectRandomWeightedItemFromStream(const FRandomStream& Stream, const TArray<FSWeightedItem>& Items);
+
+	// SelectRandomWeightedItem drawing from a native generator, e.g. RancRandom::GetThreadStream() on worker threads.
+	static UObject* SelectRandomWeightedItem(FRancRandom& Random, const TArray<FSWeightedItem>& Items);
+
 	// Selects a random item from an array of IWeightedItem interface objects.
 	// @param Items - Array of IWeightedItem interface pointers.
 	// @return IWeightedItem* - The selected IWeightedItem interface pointer.
 	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
 	static TScriptInterface<IWeightedItem> SelectRandomIWeightedItem(const TArray<TScriptInterface<IWeightedItem>>& Items);
+
+	// SelectRandomIWeightedItem drawing from Stream.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TScriptInterface<IWeightedItem> SelectRandomIWeightedItemFromStream(const FRandomStream& Stream, const TArray<TScriptInterface<IWeightedItem>>& Items);
+
+	static TScriptInterface<IWeightedItem> SelectRandomIWeightedItem(FRancRandom& Random, const TArray<TScriptInterface<IWeightedItem>>& Items);
 	
 	// Selects a random index from an array using a delegate to get weights.
 	// @param Items - Array of UObject items.
@@ -65,6 +85,25 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
 	static int SelectRandomItemIndex(const TArray<UObject*>& Items, const FGetWeightDelegate& GetWeight);
 
+	// SelectRandomItemIndex drawing from Stream.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static int SelectRandomItemIndexFromStream(const FRandomStream& Stream, const TArray<UObject*>& Items, const FGetWeightDelegate& GetWeight);
+
+	// Selects a random index from an array using one delegate call that returns every weight.
+	// @param Items - Array of UObject items.
+	// @param GetWeights - Delegate returning one weight per item, in item order.
+	// @return int - The index of the selected item, -1 if the delegate returned the wrong number of weights.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static int SelectRandomItemIndexBatched(const TArray<UObject*>& Items, const FGetWeightsDelegate& GetWeights);
+
+	// Native version of SelectRandomItemIndex, GetWeight is called once per index.
+	// @param ItemCount - The number of items.
+	// @param GetWeight - Returns the weight for an index.
+	// @return int - The index of the selected item, -1 if ItemCount is 0.
+	static int SelectRandomItemIndex(int32 ItemCount, TFunctionRef<float(int32)> GetWeight);
+
+	static int SelectRandomItemIndex(FRancRandom& Random, int32 ItemCount, TFunctionRef<float(int32)> GetWeight);
+
 	// Selects a random index from an array of weights.
 	// @param Weights - Array of floats representing the weights.
 	// If the array is empty, the function will return index 0.
@@ -73,12 +112,133 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
 	static int SelectRandomWeightedIndex(const TArray<float>& Weights);
 
+	// Native version of SelectRandomWeightedIndex for weights that are not in a TArray<float>, e.g. inline or scratch buffers
+	static int SelectRandomWeightedIndex(TConstArrayView<float> Weights);
+
+	// SelectRandomWeightedIndex drawing from Stream.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static int SelectRandomWeightedIndexFromStream(const FRandomStream& Stream, const TArray<float>& Weights);
+
+	static int SelectRandomWeightedIndex(FRancRandom& Random, TConstArrayView<float> Weights);
+
+	// Selects Count random indices (with replacement) from an array of weights.
+	// The prefix sums are built once with SIMD and each draw is a branchless binary search, O(n + Count log n) in total
+	// instead of O(n) per draw. Negative weights count as 0. If the weights are all 0 the draws are uniform.
+	// @param Weights - Array of floats representing the weights.
+	// @param Count - The number of indices to select.
+	// @return TArray<int> - The selected indices, empty if Weights is empty.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TArray<int> SelectManyWeightedIndices(const TArray<float>& Weights, int Count);
+
+	// SelectManyWeightedIndices drawing from Stream.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TArray<int> SelectManyWeightedIndicesFromStream(const FRandomStream& Stream, const TArray<float>& Weights, int Count);
+
+	// Native SelectManyWeightedIndices, appends to OutIndices.
+	static void SelectManyWeightedIndices(FRancRandom& Random, TConstArrayView<float> Weights, int32 Count, TArray<int32>& OutIndices);
+
+	// Selects up to K distinct items in one O(n log K) pass (Efraimidis-Spirakis A-Res), without copying the array.
+	// The result is in draw order, the same distribution as picking and removing one weighted item K times.
+	// Items with a weight of 0 are only picked once every positive weight item has been picked.
+	// @param Items - Array of FSWeightedItem containing the items and their respective weights.
+	// @param K - The number of items to select. If there are fewer items, all of them are returned.
+	// @return TArray<UObject*> - The selected items.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TArray<UObject*> SelectKWeightedWithoutReplacement(const TArray<FSWeightedItem>& Items, int K);
+
+	// SelectKWeightedWithoutReplacement drawing from Stream.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TArray<UObject*> SelectKWeightedWithoutReplacementFromStream(const FRandomStream& Stream, const TArray<FSWeightedItem>& Items, int K);
+
+	static TArray<UObject*> SelectKWeightedWithoutReplacement(FRancRandom& Random, const TArray<FSWeightedItem>& Items, int K);
+
+	// Selects up to K distinct indices from an array of weights, see SelectKWeightedWithoutReplacement.
+	// @param Weights - Array of floats representing the weights.
+	// @param K - The number of indices to select.
+	// @return TArray<int> - The selected indices.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TArray<int> SelectKWeightedIndicesWithoutReplacement(const TArray<float>& Weights, int K);
+
+	// SelectKWeightedIndicesWithoutReplacement drawing from Stream.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TArray<int> SelectKWeightedIndicesWithoutReplacementFromStream(const FRandomStream& Stream, const TArray<float>& Weights, int K);
+
+	static TArray<int> SelectKWeightedIndicesWithoutReplacement(FRancRandom& Random, TConstArrayView<float> Weights, int K);
+
+	// Selects up to K distinct IWeightedItems, calling GetWeight once per item. Invalid items are skipped.
+	// @param Items - Array of IWeightedItem interface pointers.
+	// @param K - The number of items to select.
+	// @return TArray<TScriptInterface<IWeightedItem>> - The selected items.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TArray<TScriptInterface<IWeightedItem>> SelectKIWeightedItemsWithoutReplacement(const TArray<TScriptInterface<IWeightedItem>>& Items, int K);
+
+	// SelectKIWeightedItemsWithoutReplacement drawing from Stream.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TArray<TScriptInterface<IWeightedItem>> SelectKIWeightedItemsWithoutReplacementFromStream(const FRandomStream& Stream,
+		const TArray<TScriptInterface<IWeightedItem>>& Items, int K);
+
+	static TArray<TScriptInterface<IWeightedItem>> SelectKIWeightedItemsWithoutReplacement(FRancRandom& Random,
+		const TArray<TScriptInterface<IWeightedItem>>& Items, int K);
+
+	// Selects a random actor of ActorClass from the world, weighted by its IWeightedItem weight.
+	// Streams over the actors with a constant-memory reservoir, so no array of candidates is built.
+	// Actors that don't implement IWeightedItem are ignored.
+	// @param ActorClass - The class of actors to consider.
+	// @return AActor* - The selected actor, null if there is none.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector", meta = (WorldContext = "WorldContextObject", DeterminesOutputType = "ActorClass"))
+	static AActor* SelectRandomIWeightedActor(const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass);
+
+	// SelectRandomIWeightedActor drawing from Stream. Actors are visited in iteration order, so the same seed
+	// gives the same actor as long as the world holds the same actors.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector", meta = (WorldContext = "WorldContextObject", DeterminesOutputType = "ActorClass"))
+	static AActor* SelectRandomIWeightedActorFromStream(const FRandomStream& Stream, const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass);
+
+	static AActor* SelectRandomIWeightedActor(FRancRandom& Random, const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass);
+
+	// Selects a random actor of ActorClass from the world, weighted by GetWeight, see SelectRandomIWeightedActor.
+	// @param ActorClass - The class of actors to consider.
+	// @param GetWeight - Delegate to provide the weight of each actor.
+	// @return AActor* - The selected actor, null if there is none.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector", meta = (WorldContext = "WorldContextObject", DeterminesOutputType = "ActorClass"))
+	static AActor* SelectRandomWeightedActor(const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass, const FGetActorWeightDelegate& GetWeight);
+
+	// SelectRandomWeightedActor drawing from Stream, see SelectRandomIWeightedActorFromStream.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector", meta = (WorldContext = "WorldContextObject", DeterminesOutputType = "ActorClass"))
+	static AActor* SelectRandomWeightedActorFromStream(const FRandomStream& Stream, const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass,
+		const FGetActorWeightDelegate& GetWeight);
+
+	static AActor* SelectRandomWeightedActor(FRancRandom& Random, const UObject* WorldContextObject, TSubclassOf<AActor> ActorClass,
+		const FGetActorWeightDelegate& GetWeight);
+
 	// Gets a random dice roll based on the number of dice and sides.
+	// Larger pools are drawn in O(1) from a distribution that is built once per (DiceCount, DiceSides, bDiceHas0) and cached.
 	// @param DiceCount - The number of dice to roll.
 	// @param DiceSides - The number of sides on each die.
 	// @param bDiceHas0 - Whether the dice can roll a 0.
 	// @return int - The result of the dice roll.
 	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
 	static int RollDice(int DiceCount, int DiceSides, bool bDiceHas0 = false);
+
+	// RollDice drawing from Stream.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static int RollDiceFromStream(const FRandomStream& Stream, int DiceCount, int DiceSides, bool bDiceHas0 = false);
+
+	static int RollDice(FRancRandom& Random, int DiceCount, int DiceSides, bool bDiceHas0 = false);
+
+	// Rolls the same dice pool Count times, see RollDice.
+	// @return TArray<int> - The results of the rolls.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TArray<int> RollDiceMany(int DiceCount, int DiceSides, int Count, bool bDiceHas0 = false);
+
+	// RollDiceMany drawing from Stream.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TArray<int> RollDiceManyFromStream(const FRandomStream& Stream, int DiceCount, int DiceSides, int Count, bool bDiceHas0 = false);
+
+	static void RollDiceMany(FRancRandom& Random, int DiceCount, int DiceSides, int Count, TArray<int32>& OutResults, bool bDiceHas0 = false);
+
+	// Gets the exact probability of every total of a dice pool, starting at the lowest possible total.
+	// @return TArray<float> - Element i is the probability of rolling the lowest total + i.
+	UFUNCTION(BlueprintCallable, Category = "WeightedRandomSelector")
+	static TArray<float> GetDiceDistribution(int DiceCount, int DiceSides, bool bDiceHas0 = false);
 	
 };
\ No newline at end of file
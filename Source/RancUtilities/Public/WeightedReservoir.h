@@ -0,0 +1,142 @@
+﻿// Copyright Rancorous Games, 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RancRandom.h"
+#include <iterator>
+#include <type_traits>
+
+/**
+ * TWeightedReservoir picks one weighted random item from a stream of items seen one at a time,
+ * without knowing the count up front or storing the items (Chao's weighted reservoir).
+ * Each positive weight item replaces the current pick with probability Weight / TotalWeightSoFar.
+ *
+ * Weights follow UWeightedRandomSelector: if every weight is 0 the pick is uniform. Negative weights count as 0.
+ *
+ * Example, a spawn point from every actor in the world without building an array:
+ *	TWeightedReservoir<AActor*> Reservoir;
+ *	for (AActor* Actor : TActorRange<AActor>(World)) { Reservoir.Add(Actor, GetSpawnWeight(Actor)); }
+ *	AActor* Picked = Reservoir.HasSelection() ? Reservoir.GetSelection() : nullptr;
+ *
+ * Add(Random, Item, Weight) draws from an FRandomStream or FRancRandom instead of the global generator for reproducible picks.
+ */
+template <typename ItemType>
+class TWeightedReservoir
+{
+public:
+	void Add(const ItemType& Item, float Weight)
+	{
+		FRancGlobalRandom Random;
+		Add(Random, Item, Weight);
+	}
+
+	template <typename RandomType>
+	void Add(RandomType& Random, const ItemType& Item, float Weight)
+	{
+		++NumSeen;
+		if (Weight > 0.f)
+		{
+			TotalWeight += Weight;
+			// <= so the first positive weight item is always taken even if FRand returns 1
+			if (Random.FRand() * TotalWeight <= Weight)
+			{
+				WeightedPick = Item;
+			}
+		}
+		else if (TotalWeight <= 0.0 && Random.RandHelper(NumSeen) == 0)
+		{
+			// Only needed while every weight so far has been 0, then all seen items are equally likely
+			UniformPick = Item;
+		}
+	}
+
+	bool HasSelection() const
+	{
+		return NumSeen > 0;
+	}
+
+	const ItemType& GetSelection() const
+	{
+		check(HasSelection());
+		return TotalWeight > 0.0 ? WeightedPick.GetValue() : UniformPick.GetValue();
+	}
+
+	int32 GetNumSeen() const
+	{
+		return NumSeen;
+	}
+
+	double GetTotalWeight() const
+	{
+		return TotalWeight;
+	}
+
+	void Reset()
+	{
+		WeightedPick.Reset();
+		UniformPick.Reset();
+		TotalWeight = 0.0;
+		NumSeen = 0;
+	}
+
+private:
+	TOptional<ItemType> WeightedPick;
+	TOptional<ItemType> UniformPick;
+	double TotalWeight = 0.0;
+	int32 NumSeen = 0;
+};
+
+namespace RancWeighted
+{
+	/**
+	 * Picks one weighted item from any range, e.g. TActorRange<AActor>(World), a TArray or a TMap, in one pass
+	 * with constant memory. GetWeight(Item) returns the weight of each element.
+	 * Random is an FRandomStream or FRancRandom, the overload without it uses the global generator.
+	 * @return The picked element, unset if the range is empty.
+	 */
+	template <typename RandomType, typename RangeType, typename WeightFuncType>
+	auto SelectFromRange(RandomType& Random, RangeType&& Range, WeightFuncType&& GetWeight)
+	{
+		using ItemType = std::decay_t<decltype(*std::begin(Range))>;
+
+		TWeightedReservoir<ItemType> Reservoir;
+		for (auto&& Item : Range)
+		{
+			Reservoir.Add(Random, Item, GetWeight(Item));
+		}
+		return Reservoir.HasSelection() ? TOptional<ItemType>(Reservoir.GetSelection()) : TOptional<ItemType>();
+	}
+
+	template <typename RangeType, typename WeightFuncType>
+	auto SelectFromRange(RangeType&& Range, WeightFuncType&& GetWeight)
+	{
+		FRancGlobalRandom Random;
+		return SelectFromRange(Random, Forward<RangeType>(Range), Forward<WeightFuncType>(GetWeight));
+	}
+
+	/**
+	 * Picks one weighted item from a generator. Generator(ItemType& OutItem, float& OutWeight) fills in the next
+	 * item and returns false once there are no more. Random works like in SelectFromRange.
+	 * @return The picked item, unset if the generator produced nothing.
+	 */
+	template <typename ItemType, typename RandomType, typename GeneratorType>
+	TOptional<ItemType> SelectFromGenerator(RandomType& Random, GeneratorType&& Generator)
+	{
+		TWeightedReservoir<ItemType> Reservoir;
+		ItemType Item;
+		float Weight;
+		while (Generator(Item, Weight))
+		{
+			Reservoir.Add(Random, Item, Weight);
+		}
+		return Reservoir.HasSelection() ? TOptional<ItemType>(Reservoir.GetSelection()) : TOptional<ItemType>();
+	}
+
+	template <typename ItemType, typename GeneratorType>
+	TOptional<ItemType> SelectFromGenerator(GeneratorType&& Generator)
+	{
+		FRancGlobalRandom Random;
+		return SelectFromGenerator<ItemType>(Random, Forward<GeneratorType>(Generator));
+	}
+}